@@ -0,0 +1,179 @@
+// OBJ loader benchmark.
+// -------------------------------------------------------------------
+// Copyright (C) 2007 OpenEngine.dk (See AUTHORS)
+//
+// This program is free software; It is covered by the GNU General
+// Public License version 2 or any later version.
+// See the GNU General Public License for more details (see LICENSE).
+//--------------------------------------------------------------------
+
+// Generates synthetic OBJ files and times OBJResource::Load() on
+// them, reporting throughput, peak resident memory and heap
+// allocations per load.
+//
+// usage: OBJBenchmark [directory] [repeats] [scale]
+//
+// The files are written to directory (default .) and each load is
+// repeated the given number of times (default 3), of which the
+// fastest is reported. Scale multiplies the side of the grids.
+
+#include "OBJGenerator.h"
+#include <Resources/OBJResource.h>
+#include <Scene/ISceneNode.h>
+#include <Utils/Timer.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+
+#ifdef __linux__
+#include <sys/resource.h>
+#endif
+
+using namespace OpenEngine::Resources;
+using OpenEngine::Scene::ISceneNode;
+using OpenEngine::Utils::Time;
+using OpenEngine::Utils::Timer;
+
+// heap allocations of the whole program, counted by operator new
+static volatile long allocations = 0;
+static volatile long allocatedBytes = 0;
+
+void* operator new(size_t size) {
+#ifdef _MSC_VER
+    _InterlockedIncrement(&allocations);
+    _InterlockedExchangeAdd(&allocatedBytes, (long)size);
+#else
+    __sync_add_and_fetch(&allocations, 1);
+    __sync_add_and_fetch(&allocatedBytes, (long)size);
+#endif
+    void* p = malloc(size ? size : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+// standard library temporaries come from the nothrow form, and must
+// be freed by the replaced delete too
+void* operator new(size_t size, const std::nothrow_t&) throw() {
+    try {
+        return operator new(size);
+    } catch (const std::bad_alloc&) {
+        return NULL;
+    }
+}
+
+void operator delete(void* p) throw() {
+    free(p);
+}
+
+void operator delete(void* p, size_t) throw() {
+    free(p);
+}
+
+/**
+ * Reset the peak resident memory, if the system allows it.
+ */
+static void ResetPeakMemory() {
+#ifdef __linux__
+    // writing 5 to clear_refs resets VmHWM since Linux 4.0
+    FILE* f = fopen("/proc/self/clear_refs", "w");
+    if (f) {
+        fputs("5", f);
+        fclose(f);
+    }
+#endif
+}
+
+/**
+ * Get the peak resident memory in kilobytes, or 0 if unknown.
+ */
+static long PeakMemory() {
+#ifdef __linux__
+    FILE* f = fopen("/proc/self/status", "r");
+    char line[256];
+    long kb = 0;
+    while (f && fgets(line, sizeof(line), f))
+        if (sscanf(line, "VmHWM: %ld kB", &kb) == 1) break;
+    if (f) fclose(f);
+    if (kb > 0) return kb;
+    // the peak of the whole run if VmHWM is not available
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+#else
+    return 0;
+#endif
+}
+
+/**
+ * Load a file repeatedly and print a line of results.
+ */
+static void Run(const char* name, string file, OBJLoadOptions options, unsigned int repeats) {
+    OBJResource::TrimParseBuffers();
+    ResetPeakMemory();
+    unsigned long long best = ~0ull;
+    long allocs = 0, bytes = 0;
+    OBJLoadProfile profile;
+    for (unsigned int i = 0; i < repeats; ++i) {
+        OBJResource* resource = new OBJResource(file, options);
+        const long allocs0 = allocations, bytes0 = allocatedBytes;
+        const Time start = Timer::GetTime();
+        resource->Load();
+        const unsigned long long time = (Timer::GetTime() - start).AsInt();
+        allocs = allocations - allocs0;
+        bytes = allocatedBytes - bytes0;
+        if (time < best) best = time;
+        profile = resource->GetLoadProfile();
+        delete resource->GetSceneNode();
+        delete resource;
+    }
+    const double seconds = best > 0 ? best * 1e-6 : 1e-6;
+    printf("%-16s %8.2f %9u %9.2f %8.1f ", name, profile.bytesRead / 1e6, profile.faces,
+           best / 1000.0, profile.bytesRead / 1e6 / seconds);
+    if (profile.faces > 0)
+        printf("%8.2f", profile.faces / 1e6 / seconds);
+    else
+        printf("%8s", "-");
+    printf(" %9.1f %9ld %9.2f\n", PeakMemory() / 1024.0, allocs, bytes / 1e6);
+}
+
+int main(int argc, char** argv) {
+    const string dir = string(argc > 1 ? argv[1] : ".") + "/";
+    const unsigned int repeats = argc > 2 ? atoi(argv[2]) : 3;
+    const float scale = argc > 3 ? atof(argv[3]) : 1.0f;
+    const unsigned int side = (unsigned int)(512 * scale) < 2 ? 2 : (unsigned int)(512 * scale);
+
+    OBJGenerator generator;
+    printf("writing test files to %s\n", dir.c_str());
+    bool ok = generator.WriteProps(dir + "props.obj", 32, 8)
+        && generator.WriteGrid(dir + "dense_v.obj", side, OBJ_FACE_V)
+        && generator.WriteGrid(dir + "dense_v_vt.obj", side, OBJ_FACE_V_VT)
+        && generator.WriteGrid(dir + "dense_v_vn.obj", side, OBJ_FACE_V_VN)
+        && generator.WriteGrid(dir + "dense_v_vt_vn.obj", side, OBJ_FACE_V_VT_VN)
+        && generator.WriteGrid(dir + "dense_separate.obj", side, OBJ_FACE_SEPARATE)
+        && generator.WriteMaterials(dir + "materials.obj", dir + "materials.mtl", side / 2, 256)
+        && generator.WriteElements(dir + "elements.obj", side / 2)
+        && generator.WriteCloud(dir + "cloud.obj", side * side * 2, true);
+    if (!ok) {
+        fprintf(stderr, "could not write the test files to %s\n", dir.c_str());
+        return 1;
+    }
+
+    printf("%-16s %8s %9s %9s %8s %8s %9s %9s %9s\n", "file", "MB", "triangles", "best ms",
+           "MB/s", "Mtri/s", "peak MB", "allocs", "alloc MB");
+    OBJLoadOptions options;
+    Run("props", dir + "props.obj", options, repeats * 10);
+    Run("dense v", dir + "dense_v.obj", options, repeats);
+    Run("dense v/vt", dir + "dense_v_vt.obj", options, repeats);
+    Run("dense v//vn", dir + "dense_v_vn.obj", options, repeats);
+    Run("dense v/vt/vn", dir + "dense_v_vt_vn.obj", options, repeats);
+    Run("dense separate", dir + "dense_separate.obj", options, repeats);
+    Run("materials", dir + "materials.obj", options, repeats);
+    Run("elements", dir + "elements.obj", options, repeats);
+    Run("cloud", dir + "cloud.obj", options, repeats);
+    options.pointCloud = true;
+    Run("cloud fast path", dir + "cloud.obj", options, repeats);
+    return 0;
+}
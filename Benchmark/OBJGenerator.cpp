@@ -0,0 +1,203 @@
+// Synthetic OBJ files for benchmarking.
+// -------------------------------------------------------------------
+// Copyright (C) 2007 OpenEngine.dk (See AUTHORS)
+//
+// This program is free software; It is covered by the GNU General
+// Public License version 2 or any later version.
+// See the GNU General Public License for more details (see LICENSE).
+//--------------------------------------------------------------------
+
+#include "OBJGenerator.h"
+
+namespace OpenEngine {
+namespace Resources {
+
+/**
+ * Create a generator.
+ *
+ * @param seed Seed of the random heights and colours
+ */
+OBJGenerator::OBJGenerator(unsigned int seed)
+    : state(seed) {}
+
+/**
+ * Get a pseudo random number in [0;1).
+ */
+float OBJGenerator::Random() {
+    state = state * 1664525u + 1013904223u;
+    return (state >> 8) * (1.0f / 16777216.0f);
+}
+
+/**
+ * Write the vertices and triangles of a size x size height field.
+ *
+ * @param out File to write to
+ * @param size Vertices along each side, at least 2
+ * @param format Corner format of the faces
+ * @param materials Number of materials to use for bands of rows, or 0
+ *                  to write no usemtl lines
+ * @param base Vertices written to the file before the grid
+ * @return False if writing failed
+ */
+bool OBJGenerator::Grid(FILE* out, unsigned int size, OBJFaceFormat format,
+                        unsigned int materials, unsigned int base) {
+    const unsigned int count = size * size;
+    const float step = 1.0f / (size - 1);
+    for (unsigned int i = 0; i < count; ++i)
+        fprintf(out, "v %.6f %.6f %.6f\n", (i % size) * step, Random() * 0.1f, (i / size) * step);
+
+    // separate texture coordinates and normals are written backwards
+    // so their numbers differ from those of the positions
+    const bool separate = format == OBJ_FACE_SEPARATE;
+    if (format != OBJ_FACE_V && format != OBJ_FACE_V_VN)
+        for (unsigned int i = 0; i < count; ++i) {
+            unsigned int v = separate ? count - 1 - i : i;
+            fprintf(out, "vt %.6f %.6f\n", (v % size) * step, (v / size) * step);
+        }
+    if (format != OBJ_FACE_V && format != OBJ_FACE_V_VT)
+        for (unsigned int i = 0; i < count; ++i)
+            fprintf(out, "vn %.4f 1.0 %.4f\n", (Random() - 0.5f) * 0.2f, (Random() - 0.5f) * 0.2f);
+
+    unsigned int face = 0, material = ~0u;
+    for (unsigned int y = 0; y + 1 < size; ++y) {
+        if (materials > 0 && y * materials / (size - 1) != material) {
+            material = y * materials / (size - 1);
+            fprintf(out, "usemtl m%u\n", material);
+        }
+        for (unsigned int x = 0; x + 1 < size; ++x)
+            for (unsigned int t = 0; t < 2; ++t, ++face) {
+                const unsigned int quad[4] = { y*size + x, y*size + x + 1,
+                                               (y+1)*size + x + 1, (y+1)*size + x };
+                const unsigned int corners[2][3] = { { 0, 3, 2 }, { 0, 2, 1 } };
+                OBJFaceFormat f = format == OBJ_FACE_MIXED ? OBJFaceFormat(face % 4) : format;
+                fputc('f', out);
+                for (unsigned int k = 0; k < 3; ++k) {
+                    unsigned int v = quad[corners[t][k]] + 1;
+                    unsigned int o = separate ? count - v + 1 : v;
+                    if (f == OBJ_FACE_V)
+                        fprintf(out, " %u", base + v);
+                    else if (f == OBJ_FACE_V_VT)
+                        fprintf(out, " %u/%u", base + v, base + v);
+                    else if (f == OBJ_FACE_V_VN)
+                        fprintf(out, " %u//%u", base + v, base + v);
+                    else
+                        fprintf(out, " %u/%u/%u", base + v, base + o, base + o);
+                }
+                fputc('\n', out);
+            }
+    }
+    return !ferror(out);
+}
+
+/**
+ * Write a height field grid.
+ *
+ * @param file Path of the OBJ file
+ * @param size Vertices along each side, at least 2
+ * @param format Corner format of the faces
+ * @return False if the file could not be written
+ */
+bool OBJGenerator::WriteGrid(string file, unsigned int size, OBJFaceFormat format) {
+    FILE* out = fopen(file.c_str(), "w");
+    if (!out) return false;
+    fprintf(out, "# %ux%u grid\n", size, size);
+    bool ok = Grid(out, size, format, 0, 0);
+    return fclose(out) == 0 && ok;
+}
+
+/**
+ * Write many small objects side by side, as found in files of props.
+ *
+ * @param file Path of the OBJ file
+ * @param objects Number of objects
+ * @param size Vertices along each side of an object
+ * @return False if the file could not be written
+ */
+bool OBJGenerator::WriteProps(string file, unsigned int objects, unsigned int size) {
+    FILE* out = fopen(file.c_str(), "w");
+    if (!out) return false;
+    bool ok = true;
+    for (unsigned int i = 0; ok && i < objects; ++i) {
+        fprintf(out, "o prop%u\n", i);
+        ok = Grid(out, size, OBJ_FACE_V_VT_VN, 0, i * size * size);
+    }
+    return fclose(out) == 0 && ok;
+}
+
+/**
+ * Write a grid whose bands of rows use different materials, and the
+ * material file defining them.
+ *
+ * @param file Path of the OBJ file
+ * @param mtlFile Path of the material file, in the same directory
+ * @param size Vertices along each side of the grid
+ * @param materials Number of materials
+ * @return False if the files could not be written
+ */
+bool OBJGenerator::WriteMaterials(string file, string mtlFile, unsigned int size,
+                                  unsigned int materials) {
+    FILE* mtl = fopen(mtlFile.c_str(), "w");
+    if (!mtl) return false;
+    for (unsigned int i = 0; i < materials; ++i) {
+        fprintf(mtl, "newmtl m%u\n", i);
+        fprintf(mtl, "Ka 0.2 0.2 0.2\n");
+        fprintf(mtl, "Kd %.3f %.3f %.3f\n", Random(), Random(), Random());
+        fprintf(mtl, "Ks 1.0 1.0 1.0\n");
+        fprintf(mtl, "Ns %.1f\n", Random() * 100.0f);
+    }
+    if (fclose(mtl) != 0) return false;
+
+    FILE* out = fopen(file.c_str(), "w");
+    if (!out) return false;
+    string::size_type slash = mtlFile.find_last_of("/\\");
+    fprintf(out, "mtllib %s\n", mtlFile.substr(slash == string::npos ? 0 : slash + 1).c_str());
+    bool ok = Grid(out, size, OBJ_FACE_V_VT_VN, materials, 0);
+    return fclose(out) == 0 && ok;
+}
+
+/**
+ * Write a grid of faces in every corner format, with a line element
+ * along each row and a point element on each column.
+ *
+ * @param file Path of the OBJ file
+ * @param size Vertices along each side of the grid
+ * @return False if the file could not be written
+ */
+bool OBJGenerator::WriteElements(string file, unsigned int size) {
+    FILE* out = fopen(file.c_str(), "w");
+    if (!out) return false;
+    bool ok = Grid(out, size, OBJ_FACE_MIXED, 0, 0);
+    for (unsigned int y = 0; y < size; ++y) {
+        fputc('l', out);
+        for (unsigned int x = 0; x < size; ++x)
+            fprintf(out, " %u", y*size + x + 1);
+        fputc('\n', out);
+    }
+    for (unsigned int x = 0; x < size; ++x)
+        fprintf(out, "p %u\n", x + 1);
+    return fclose(out) == 0 && ok;
+}
+
+/**
+ * Write a file of vertices only, which is loaded as a point cloud.
+ *
+ * @param file Path of the OBJ file
+ * @param points Number of vertices
+ * @param colors Give the vertices colours
+ * @return False if the file could not be written
+ */
+bool OBJGenerator::WriteCloud(string file, unsigned int points, bool colors) {
+    FILE* out = fopen(file.c_str(), "w");
+    if (!out) return false;
+    for (unsigned int i = 0; i < points; ++i) {
+        float x = Random() * 100.0f, y = Random() * 100.0f, z = Random() * 100.0f;
+        if (colors)
+            fprintf(out, "v %.5f %.5f %.5f %.3f %.3f %.3f\n", x, y, z, Random(), Random(), Random());
+        else
+            fprintf(out, "v %.5f %.5f %.5f\n", x, y, z);
+    }
+    return fclose(out) == 0;
+}
+
+} // NS Resources
+} // NS OpenEngine
@@ -0,0 +1,65 @@
+// Synthetic OBJ files for benchmarking.
+// -------------------------------------------------------------------
+// Copyright (C) 2007 OpenEngine.dk (See AUTHORS)
+//
+// This program is free software; It is covered by the GNU General
+// Public License version 2 or any later version.
+// See the GNU General Public License for more details (see LICENSE).
+//--------------------------------------------------------------------
+
+#ifndef _OBJ_GENERATOR_H_
+#define _OBJ_GENERATOR_H_
+
+#include <cstdio>
+#include <string>
+
+namespace OpenEngine {
+namespace Resources {
+
+using namespace std;
+
+/**
+ * Corner formats of generated faces.
+ */
+enum OBJFaceFormat {
+    OBJ_FACE_V,          //!< f v v v
+    OBJ_FACE_V_VT,       //!< f v/vt, texture coordinates numbered like the positions
+    OBJ_FACE_V_VN,       //!< f v//vn, normals numbered like the positions
+    OBJ_FACE_V_VT_VN,    //!< f v/vt/vn, all numbered like the positions
+    OBJ_FACE_SEPARATE,   //!< f v/vt/vn with texture coordinates and normals of their own
+    OBJ_FACE_MIXED       //!< all of the above, face by face
+};
+
+/**
+ * Writer of deterministic OBJ and MTL files.
+ *
+ * The files are grids of triangles over a height field and clouds of
+ * points, so they can be made as large as needed. A seeded linear
+ * congruential generator provides the heights and colours, which
+ * makes the output the same on every platform and run.
+ *
+ * @class OBJGenerator OBJGenerator.h "OBJGenerator.h"
+ */
+class OBJGenerator {
+private:
+    unsigned int state; //!< random generator state
+
+    float Random();
+    bool Grid(FILE* out, unsigned int size, OBJFaceFormat format,
+              unsigned int materials, unsigned int base);
+
+public:
+    OBJGenerator(unsigned int seed = 1);
+
+    bool WriteGrid(string file, unsigned int size, OBJFaceFormat format);
+    bool WriteProps(string file, unsigned int objects, unsigned int size);
+    bool WriteMaterials(string file, string mtlFile, unsigned int size,
+                        unsigned int materials);
+    bool WriteElements(string file, unsigned int size);
+    bool WriteCloud(string file, unsigned int points, bool colors);
+};
+
+} // NS Resources
+} // NS OpenEngine
+
+#endif // _OBJ_GENERATOR_H_
@@ -0,0 +1,460 @@
+// OBJ parser microbenchmarks.
+// -------------------------------------------------------------------
+// Copyright (C) 2007 OpenEngine.dk (See AUTHORS)
+//
+// This program is free software; It is covered by the GNU General
+// Public License version 2 or any later version.
+// See the GNU General Public License for more details (see LICENSE).
+//--------------------------------------------------------------------
+
+// Times the primitives the OBJ loader is built from on a generated
+// grid held in memory: line splitting, number parsing, face parsing,
+// duplicate face hashing and the loop expanding faces into vertex
+// arrays. The variants of each stage are printed side by side, the
+// one used by the loader first. Vector variants are only built when
+// the compiler targets the instructions they need.
+//
+// usage: OBJMicroBenchmark [directory] [repeats] [scale]
+//
+// The grid is written to directory (default .) and each variant is
+// run the given number of times (default 5), of which the fastest
+// is reported. Cycles per byte are read from the hardware cycle
+// counter with perf_event_open on Linux, and left out when the
+// counter is not available.
+
+#include "OBJGenerator.h"
+#include <Resources/OBJParser.h>
+#include <Resources/OBJFaceKey.h>
+#include <Resources/OBJMeshData.h>
+#include <Math/Vector.h>
+#include <Utils/Timer.h>
+
+#include <boost/unordered_set.hpp>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#ifdef __SSE4_2__
+#include <nmmintrin.h>
+#endif
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+using namespace OpenEngine::Resources;
+using OpenEngine::Math::Vector;
+using OpenEngine::Utils::Time;
+using OpenEngine::Utils::Timer;
+
+/**
+ * Counter of the CPU cycles spent by this thread.
+ */
+class CycleCounter {
+private:
+    int fd;
+
+public:
+    CycleCounter() : fd(-1) {
+#ifdef __linux__
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = PERF_COUNT_HW_CPU_CYCLES;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+#endif
+    }
+
+    ~CycleCounter() {
+#ifdef __linux__
+        if (fd >= 0) close(fd);
+#endif
+    }
+
+    bool IsAvailable() const { return fd >= 0; }
+
+    void Start() {
+#ifdef __linux__
+        if (fd < 0) return;
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+    }
+
+    unsigned long long Stop() {
+        unsigned long long cycles = 0;
+#ifdef __linux__
+        if (fd < 0) return 0;
+        ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        if (read(fd, &cycles, sizeof(cycles)) != sizeof(cycles))
+            cycles = 0;
+#endif
+        return cycles;
+    }
+};
+
+#ifdef __SSE4_2__
+/**
+ * Face key hash using the CRC32 instruction.
+ */
+struct FaceKeyCrc {
+    std::size_t operator()(const OBJFaceKey& key) const {
+        unsigned int crc = 0;
+        for (unsigned int i = 0; i < 9; ++i)
+            crc = _mm_crc32_u32(crc, key.idx[i]);
+        return crc;
+    }
+};
+#endif
+
+/**
+ * The test data of all stages.
+ */
+struct Input {
+    string text;     //!< the whole file
+    string vertices; //!< the v lines, each terminated by a zero
+    string faces;    //!< the f lines, each terminated by a zero
+    unsigned int vertexLines, faceLines;
+    vector<unsigned int> indices; //!< zero based v/vt/vn of each corner
+    vector<Vector<3,float> > vert, norm;
+    vector<Vector<2,float> > texc;
+    vector<float> flatVert, flatNorm, flatTexc; //!< the same, packed
+};
+
+// results are added here so no variant is optimized away
+static volatile unsigned long long sink = 0;
+
+typedef unsigned long long (*Variant)(const Input& in);
+
+/**
+ * Run a variant repeatedly and print a line for the fastest run.
+ *
+ * @param stage Name of the stage
+ * @param name Name of the variant
+ * @param variant The variant, returning a checksum
+ * @param in Test data
+ * @param bytes Bytes of input processed by a run
+ * @param items Lines, numbers or faces processed by a run
+ * @param repeats Number of runs
+ */
+static void Measure(const char* stage, const char* name, Variant variant, const Input& in,
+                    size_t bytes, size_t items, unsigned int repeats) {
+    CycleCounter counter;
+    unsigned long long best = ~0ull, bestCycles = ~0ull, sum = 0;
+    for (unsigned int i = 0; i < repeats; ++i) {
+        const Time start = Timer::GetTime();
+        counter.Start();
+        sum = variant(in);
+        const unsigned long long cycles = counter.Stop();
+        const unsigned long long time = (Timer::GetTime() - start).AsInt();
+        best = std::min(best, time);
+        bestCycles = std::min(bestCycles, cycles);
+    }
+    sink = sink + sum;
+    const double seconds = best > 0 ? best * 1e-6 : 1e-6;
+    printf("%-8s %-16s %9.2f %9.1f %9.2f", stage, name, best / 1000.0,
+           bytes / 1e6 / seconds, seconds * 1e9 / items);
+    if (counter.IsAvailable() && bytes > 0)
+        printf(" %9.2f\n", double(bestCycles) / bytes);
+    else
+        printf(" %9s\n", "-");
+}
+
+// LINE SPLITTING
+
+static unsigned long long SplitScalar(const Input& in) {
+    const char* s = in.text.data();
+    const char* end = s + in.text.size();
+    unsigned long long lines = 0;
+    for (; s < end; ++s)
+        if (*s == '\n') ++lines;
+    return lines;
+}
+
+static unsigned long long SplitMemchr(const Input& in) {
+    const char* s = in.text.data();
+    const char* end = s + in.text.size();
+    unsigned long long lines = 0;
+    for (; s < end; s = OBJParser::NextLine(s, end))
+        ++lines;
+    return lines;
+}
+
+#ifdef __SSE2__
+static unsigned long long SplitSSE2(const Input& in) {
+    const char* s = in.text.data();
+    const char* end = s + in.text.size();
+    const __m128i nl = _mm_set1_epi8('\n');
+    unsigned long long lines = 0;
+    for (; s + 16 <= end; s += 16) {
+        __m128i chunk = _mm_loadu_si128((const __m128i*)s);
+        unsigned int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, nl));
+        for (; mask; mask &= mask - 1)
+            ++lines;
+    }
+    for (; s < end; ++s)
+        if (*s == '\n') ++lines;
+    return lines;
+}
+#endif
+
+// NUMBER PARSING
+
+static unsigned long long FloatsSscanf(const Input& in) {
+    const char* s = in.vertices.data();
+    const char* end = s + in.vertices.size();
+    double sum = 0.0, d1, d2, d3;
+    for (; s < end; s += strlen(s) + 1)
+        if (sscanf(s, "v %lf %lf %lf", &d1, &d2, &d3) == 3)
+            sum += d1 + d2 + d3;
+    return (unsigned long long)sum;
+}
+
+static unsigned long long FloatsStrtod(const Input& in) {
+    const char* s = in.vertices.data();
+    const char* end = s + in.vertices.size();
+    double sum = 0.0;
+    for (; s < end; s += strlen(s) + 1) {
+        char* p = (char*)s + 1;
+        for (unsigned int i = 0; i < 3; ++i)
+            sum += strtod(p, &p);
+    }
+    return (unsigned long long)sum;
+}
+
+static unsigned long long FloatsParser(const Input& in) {
+    const char* s = in.vertices.data();
+    const char* end = s + in.vertices.size();
+    double sum = 0.0, d[3];
+    while (s < end) {
+        const char* lineEnd = s + strlen(s);
+        const char* p = s + 1;
+        if (OBJParser::ParseDoubles(p, lineEnd, d, 3) == 3)
+            sum += d[0] + d[1] + d[2];
+        s = lineEnd + 1;
+    }
+    return (unsigned long long)sum;
+}
+
+// FACE PARSING
+
+static unsigned long long FacesSscanf(const Input& in) {
+    const char* s = in.faces.data();
+    const char* end = s + in.faces.size();
+    unsigned long long sum = 0;
+    char s1[255], s2[255], s3[255], s4[255];
+    for (; s < end; s += strlen(s) + 1) {
+        int f[9] = { 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+        if (sscanf(s, "f %s %s %s %s", s1, s2, s3, s4) != 3) continue;
+        if (sscanf(s, "f %d/%d/%d %d/%d/%d %d/%d/%d", &f[0],&f[1],&f[2],&f[3],&f[4],&f[5],&f[6],&f[7],&f[8]) == 9
+            || sscanf(s, "f %d//%d %d//%d %d//%d", &f[0],&f[2],&f[3],&f[5],&f[6],&f[8]) == 6
+            || sscanf(s, "f %d %d %d", &f[0],&f[3],&f[6]) == 3)
+            for (unsigned int i = 0; i < 9; ++i)
+                sum += f[i];
+    }
+    return sum;
+}
+
+/**
+ * Parse a v, v//vn or v/vt/vn corner into three numbers, missing
+ * ones are 0.
+ */
+static bool ParseCorner(const char*& s, int* f) {
+    for (unsigned int j = 0; j < 3; ++j) {
+        int n = 0;
+        const char* p = s;
+        for (; (unsigned)(*p - '0') < 10; ++p)
+            n = n * 10 + (*p - '0');
+        if (p == s && j == 0) return false;
+        f[j] = n;
+        s = p;
+        if (*s != '/') return true;
+        ++s;
+    }
+    return true;
+}
+
+static unsigned long long FacesParser(const Input& in) {
+    const char* s = in.faces.data();
+    const char* end = s + in.faces.size();
+    unsigned long long sum = 0;
+    while (s < end) {
+        const char* lineEnd = s + strlen(s);
+        const char* p = s + 1;
+        int f[9] = { 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+        unsigned int k = 0;
+        for (p = OBJParser::SkipSpaces(p, lineEnd); p < lineEnd && k < 4;
+             p = OBJParser::SkipSpaces(p, lineEnd), ++k)
+            if (k == 3 || !ParseCorner(p, f + k*3)) break;
+        if (k == 3 && p == lineEnd)
+            for (unsigned int i = 0; i < 9; ++i)
+                sum += f[i];
+        s = lineEnd + 1;
+    }
+    return sum;
+}
+
+// DUPLICATE FACE HASHING
+
+template <class Set>
+static unsigned long long Deduplicate(const Input& in) {
+    Set faces;
+    unsigned long long unique = 0;
+    for (unsigned int i = 0; i + 9 <= in.indices.size(); i += 9)
+        unique += faces.insert(OBJFaceKey(&in.indices[i])).second;
+    return unique;
+}
+
+// FACE EXPANSION
+
+static unsigned long long ExpandVectors(const Input& in) {
+    const unsigned int corners = in.indices.size() / 3;
+    OBJMeshData data(corners, corners / 3);
+    for (unsigned int out = 0; out < corners; ++out) {
+        const unsigned int* f = &in.indices[out*3];
+        Vector<3,float> v3;
+        Vector<2,float> v2(0.0f);
+        data.indices[out] = out;
+        v3 = in.vert[f[0]];
+        v3.ToArray(&data.vertices[out*3]);
+        v3 = f[2] < in.norm.size() ? in.norm[f[2]] : Vector<3,float>(0.0f);
+        v3.ToArray(&data.normals[out*3]);
+        if (f[1] < in.texc.size())
+            v2 = in.texc[f[1]];
+        v2.ToArray(&data.texcoords[out*2]);
+    }
+    return data.vertices[0] + data.normals[corners*3 - 1] + data.texcoords[corners - 1];
+}
+
+static unsigned long long ExpandMemcpy(const Input& in) {
+    const unsigned int corners = in.indices.size() / 3;
+    OBJMeshData data(corners, corners / 3);
+    static const float zero[3] = { 0.0f, 0.0f, 0.0f };
+    const float* vert = &in.flatVert[0];
+    const float* norm = in.norm.empty() ? zero : &in.flatNorm[0];
+    const float* texc = in.texc.empty() ? zero : &in.flatTexc[0];
+    for (unsigned int out = 0; out < corners; ++out) {
+        const unsigned int* f = &in.indices[out*3];
+        data.indices[out] = out;
+        memcpy(&data.vertices[out*3], vert + f[0]*3, 3 * sizeof(float));
+        memcpy(&data.normals[out*3], f[2] < in.norm.size() ? norm + f[2]*3 : zero, 3 * sizeof(float));
+        memcpy(&data.texcoords[out*2], f[1] < in.texc.size() ? texc + f[1]*2 : zero, 2 * sizeof(float));
+    }
+    return data.vertices[0] + data.normals[corners*3 - 1] + data.texcoords[corners - 1];
+}
+
+/**
+ * Read the generated file and split it into the data of the stages.
+ */
+static bool Prepare(string file, Input& in) {
+    FILE* f = fopen(file.c_str(), "rb");
+    if (!f) return false;
+    char block[65536];
+    size_t n;
+    while ((n = fread(block, 1, sizeof(block), f)) > 0)
+        in.text.append(block, n);
+    fclose(f);
+
+    in.vertexLines = in.faceLines = 0;
+    const char* end = in.text.data() + in.text.size();
+    for (const char* s = in.text.data(); s < end; s = OBJParser::NextLine(s, end)) {
+        const char* lineEnd = OBJParser::LineEnd(s, end);
+        const char* p = s + 2;
+        double d[3];
+        if (lineEnd - s > 2 && s[0] == 'v' && s[1] == ' ') {
+            in.vertices.append(s, lineEnd - s).push_back('\0');
+            in.vertexLines++;
+            if (OBJParser::ParseDoubles(p, lineEnd, d, 3) == 3) {
+                in.vert.push_back(Vector<3,float>(d[0], d[1], d[2]));
+                in.flatVert.insert(in.flatVert.end(), d, d + 3);
+            }
+        }
+        else if (lineEnd - s > 3 && s[0] == 'v' && s[1] == 'n') {
+            ++p;
+            if (OBJParser::ParseDoubles(p, lineEnd, d, 3) == 3) {
+                in.norm.push_back(Vector<3,float>(d[0], d[1], d[2]));
+                in.flatNorm.insert(in.flatNorm.end(), d, d + 3);
+            }
+        }
+        else if (lineEnd - s > 3 && s[0] == 'v' && s[1] == 't') {
+            ++p;
+            if (OBJParser::ParseDoubles(p, lineEnd, d, 2) == 2) {
+                in.texc.push_back(Vector<2,float>(d[0], d[1]));
+                in.flatTexc.insert(in.flatTexc.end(), d, d + 2);
+            }
+        }
+        else if (lineEnd - s > 2 && s[0] == 'f' && s[1] == ' ') {
+            in.faces.append(s, lineEnd - s).push_back('\0');
+            in.faceLines++;
+            int corner[9] = { 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+            p = s + 1;
+            for (unsigned int k = 0; k < 3; ++k) {
+                p = OBJParser::SkipSpaces(p, lineEnd);
+                ParseCorner(p, corner + k*3);
+            }
+            for (unsigned int i = 0; i < 9; ++i)
+                in.indices.push_back(corner[i] - 1);
+        }
+    }
+    return !in.vert.empty() && !in.indices.empty();
+}
+
+int main(int argc, char** argv) {
+    const string dir = string(argc > 1 ? argv[1] : ".") + "/";
+    const unsigned int repeats = argc > 2 ? atoi(argv[2]) : 5;
+    const float scale = argc > 3 ? atof(argv[3]) : 1.0f;
+    const unsigned int side = (unsigned int)(512 * scale) < 2 ? 2 : (unsigned int)(512 * scale);
+
+    OBJGenerator generator;
+    Input in;
+    const string file = dir + "micro.obj";
+    if (!generator.WriteGrid(file, side, OBJ_FACE_V_VT_VN) || !Prepare(file, in)) {
+        fprintf(stderr, "could not write the test file %s\n", file.c_str());
+        return 1;
+    }
+    if (!CycleCounter().IsAvailable())
+        printf("cycle counter not available, cycles per byte are left out\n");
+
+    printf("%-8s %-16s %9s %9s %9s %9s\n", "stage", "variant", "best ms", "MB/s",
+           "ns/item", "cycles/B");
+    const size_t bytes = in.text.size(), lines = std::count(in.text.begin(), in.text.end(), '\n');
+    Measure("split", "scalar", SplitScalar, in, bytes, lines, repeats);
+    Measure("split", "memchr", SplitMemchr, in, bytes, lines, repeats);
+#ifdef __SSE2__
+    Measure("split", "sse2", SplitSSE2, in, bytes, lines, repeats);
+#endif
+
+    const size_t numbers = in.vertexLines * 3;
+    Measure("float", "sscanf", FloatsSscanf, in, in.vertices.size(), numbers, repeats);
+    Measure("float", "strtod", FloatsStrtod, in, in.vertices.size(), numbers, repeats);
+    Measure("float", "OBJParser", FloatsParser, in, in.vertices.size(), numbers, repeats);
+
+    Measure("face", "sscanf", FacesSscanf, in, in.faces.size(), in.faceLines, repeats);
+    Measure("face", "scalar", FacesParser, in, in.faces.size(), in.faceLines, repeats);
+
+    // hashing and expansion read the parsed indices, not text
+    const size_t faceBytes = in.indices.size() * sizeof(unsigned int), faces = in.indices.size() / 9;
+    Measure("dedup", "boost::hash", Deduplicate<boost::unordered_set<OBJFaceKey> >,
+            in, faceBytes, faces, repeats);
+#ifdef __SSE4_2__
+    Measure("dedup", "crc32", Deduplicate<boost::unordered_set<OBJFaceKey, FaceKeyCrc> >,
+            in, faceBytes, faces, repeats);
+#endif
+
+    Measure("expand", "Vector", ExpandVectors, in, faceBytes, faces, repeats);
+    Measure("expand", "memcpy", ExpandMemcpy, in, faceBytes, faces, repeats);
+    return 0;
+}
@@ -0,0 +1,126 @@
+// OBJ half-edge adjacency.
+// -------------------------------------------------------------------
+// Copyright (C) 2007 OpenEngine.dk (See AUTHORS)
+//
+// This program is free software; It is covered by the GNU General
+// Public License version 2 or any later version.
+// See the GNU General Public License for more details (see LICENSE).
+//--------------------------------------------------------------------
+
+#include <Resources/OBJAdjacency.h>
+
+#include <boost/cstdint.hpp>
+#include <algorithm>
+#include <utility>
+
+namespace OpenEngine {
+namespace Resources {
+
+using boost::uint64_t;
+
+typedef pair<uint64_t, unsigned int> EdgeEntry;
+
+const unsigned int OBJAdjacency::NONE;
+
+/**
+ * Orders vertex numbers lexicographically by position.
+ */
+class PositionOrder {
+    const float* vertices;
+public:
+    PositionOrder(const float* vertices) : vertices(vertices) {}
+    bool operator()(unsigned int a, unsigned int b) const {
+        return std::lexicographical_compare(vertices + a*3, vertices + a*3 + 3,
+                                            vertices + b*3, vertices + b*3 + 3);
+    }
+};
+
+/**
+ * Build the adjacency of a triangle list.
+ *
+ * Positions are numbered by sorting, then every half-edge is keyed by
+ * its unordered pair of position ids and the keys are sorted so the
+ * two halves of an edge end up next to each other.
+ *
+ * @param indices Triangle list, three indices per triangle
+ * @param triangleCount Number of triangles
+ * @param vertices Vertex positions, or NULL to use the indices as
+ *                 position ids directly
+ * @param vertexCount Number of vertices
+ */
+OBJAdjacency::OBJAdjacency(const unsigned int* indices, unsigned int triangleCount,
+                           const float* vertices, unsigned int vertexCount)
+    : origin(triangleCount*3)
+    , twin(triangleCount*3, NONE)
+    , position(vertexCount) {
+    // number the distinct positions
+    unsigned int positions = vertexCount;
+    if (vertices) {
+        vector<unsigned int> order(vertexCount);
+        for (unsigned int i = 0; i < vertexCount; ++i)
+            order[i] = i;
+        std::sort(order.begin(), order.end(), PositionOrder(vertices));
+        positions = 0;
+        for (unsigned int i = 0; i < vertexCount; ++i) {
+            if (i > 0 && PositionOrder(vertices)(order[i-1], order[i]))
+                positions++;
+            position[order[i]] = positions;
+        }
+        if (vertexCount > 0) positions++;
+    } else
+        for (unsigned int i = 0; i < vertexCount; ++i)
+            position[i] = i;
+
+    // key the half-edges by their unordered position ids
+    const int count = triangleCount*3;
+    vector<EdgeEntry> edges(count);
+    #pragma omp parallel for
+    for (int h = 0; h < count; ++h) {
+        uint64_t a = position[indices[h]];
+        uint64_t b = position[indices[Next(h)]];
+        origin[h] = a;
+        edges[h] = EdgeEntry(a < b ? (a << 32) | b : (b << 32) | a, h);
+    }
+    std::sort(edges.begin(), edges.end());
+
+    // pair up manifold edges running in opposite directions
+    for (int i = 0; i < count; ) {
+        int j = i + 1;
+        while (j < count && edges[j].first == edges[i].first)
+            ++j;
+        if (j - i == 2) {
+            unsigned int h = edges[i].second, g = edges[i+1].second;
+            if (origin[h] != origin[g]) {
+                twin[h] = g;
+                twin[g] = h;
+            }
+        }
+        i = j;
+    }
+
+    // pick an outgoing half-edge for each position, preferring
+    // boundary edges so walks around a vertex can start there
+    vertexEdge.resize(positions, NONE);
+    for (int h = 0; h < count; ++h) {
+        unsigned int& e = vertexEdge[origin[h]];
+        if (e == NONE || (twin[h] == NONE && twin[e] != NONE))
+            e = h;
+    }
+}
+
+/**
+ * Get the number of half-edges, three per triangle.
+ */
+unsigned int OBJAdjacency::GetHalfEdgeCount() const {
+    return twin.size();
+}
+
+/**
+ * Get the number of distinct vertex positions.
+ */
+unsigned int OBJAdjacency::GetPositionCount() const {
+    return vertexEdge.size();
+}
+
+} // NS Resources
+} // NS OpenEngine
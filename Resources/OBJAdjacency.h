@@ -0,0 +1,77 @@
+// OBJ half-edge adjacency.
+// -------------------------------------------------------------------
+// Copyright (C) 2007 OpenEngine.dk (See AUTHORS)
+//
+// This program is free software; It is covered by the GNU General
+// Public License version 2 or any later version.
+// See the GNU General Public License for more details (see LICENSE).
+//--------------------------------------------------------------------
+
+#ifndef _OBJ_ADJACENCY_H_
+#define _OBJ_ADJACENCY_H_
+
+#include <boost/shared_ptr.hpp>
+#include <vector>
+
+namespace OpenEngine {
+namespace Resources {
+
+using namespace std;
+
+/**
+ * Half-edge adjacency of an indexed triangle list.
+ *
+ * Half-edge h is the edge of triangle h/3 going from corner h%3 to
+ * the next corner, so the next and previous half-edges and the face
+ * are implicit. The remaining data is kept as separate arrays (one
+ * entry per half-edge or per vertex) so traversals only touch the
+ * arrays they need.
+ *
+ * Vertices are identified by position, so vertices that only differ
+ * in normal or texture coordinate are still connected. Edges shared
+ * by more than two triangles are treated as boundary edges.
+ *
+ * @class OBJAdjacency OBJAdjacency.h "OBJAdjacency.h"
+ */
+class OBJAdjacency {
+public:
+    static const unsigned int NONE = ~0u; //!< missing twin or edge
+
+    vector<unsigned int> origin;     //!< position id of each half-edge origin
+    vector<unsigned int> twin;       //!< opposite half-edge or NONE
+    vector<unsigned int> position;   //!< position id of each mesh vertex
+    vector<unsigned int> vertexEdge; //!< an outgoing half-edge of each position id
+
+    OBJAdjacency(const unsigned int* indices, unsigned int triangleCount,
+                 const float* vertices, unsigned int vertexCount);
+
+    /**
+     * Get the next half-edge in the same triangle.
+     */
+    static unsigned int Next(unsigned int h) { return h % 3 == 2 ? h - 2 : h + 1; }
+
+    /**
+     * Get the previous half-edge in the same triangle.
+     */
+    static unsigned int Prev(unsigned int h) { return h % 3 == 0 ? h + 2 : h - 1; }
+
+    /**
+     * Get the triangle a half-edge belongs to.
+     */
+    static unsigned int Face(unsigned int h) { return h / 3; }
+
+    /**
+     * Test if a half-edge lies on the mesh boundary.
+     */
+    bool IsBoundary(unsigned int h) const { return twin[h] == NONE; }
+
+    unsigned int GetHalfEdgeCount() const;
+    unsigned int GetPositionCount() const;
+};
+
+typedef boost::shared_ptr<OBJAdjacency> OBJAdjacencyPtr;
+
+} // NS Resources
+} // NS OpenEngine
+
+#endif // _OBJ_ADJACENCY_H_
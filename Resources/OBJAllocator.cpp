@@ -0,0 +1,128 @@
+// OBJ loader memory allocation.
+// -------------------------------------------------------------------
+// Copyright (C) 2007 OpenEngine.dk (See AUTHORS)
+//
+// This program is free software; It is covered by the GNU General
+// Public License version 2 or any later version.
+// See the GNU General Public License for more details (see LICENSE).
+//--------------------------------------------------------------------
+
+#include <Resources/OBJAllocator.h>
+
+#include <algorithm>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+namespace OpenEngine {
+namespace Resources {
+
+const size_t OBJHugePageAllocator::HUGE_PAGE_SIZE;
+
+// alignment of arena allocations, enough for vector instructions
+static const size_t ARENA_ALIGNMENT = 16;
+
+/**
+ * Create a huge page allocator.
+ *
+ * @param threshold Smallest allocation placed in huge pages
+ */
+OBJHugePageAllocator::OBJHugePageAllocator(size_t threshold)
+    : threshold(threshold) {}
+
+/**
+ * Allocate memory, in huge pages if it is large enough.
+ */
+void* OBJHugePageAllocator::Allocate(size_t bytes) {
+#ifdef __linux__
+    if (bytes >= threshold) {
+        size_t size = (bytes + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+        void* p = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED) throw std::bad_alloc();
+#ifdef MADV_HUGEPAGE
+        madvise(p, size, MADV_HUGEPAGE);
+#endif
+        return p;
+    }
+#endif
+    return ::operator new(bytes);
+}
+
+/**
+ * Free memory from Allocate().
+ */
+void OBJHugePageAllocator::Deallocate(void* p, size_t bytes) {
+#ifdef __linux__
+    if (bytes >= threshold) {
+        munmap(p, (bytes + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE);
+        return;
+    }
+#endif
+    ::operator delete(p);
+}
+
+/**
+ * Create an arena.
+ *
+ * @param blockSize Bytes per block, larger allocations get a block
+ *                  of their own
+ */
+OBJArena::OBJArena(size_t blockSize)
+    : blockSize(blockSize), next(NULL), left(0), held(0) {}
+
+/**
+ * Free the blocks.
+ */
+OBJArena::~OBJArena() {
+    Release();
+}
+
+/**
+ * Hand out memory from the current block, starting a new block when
+ * it is used up.
+ */
+void* OBJArena::Allocate(size_t bytes) {
+    bytes = (bytes + ARENA_ALIGNMENT - 1) / ARENA_ALIGNMENT * ARENA_ALIGNMENT;
+    if (bytes > left) {
+        size_t size = std::max(blockSize, bytes);
+        blocks.push_back(new char[size + ARENA_ALIGNMENT]);
+        held += size + ARENA_ALIGNMENT;
+        // new[] only guarantees the alignment of fundamental types
+        size_t offset = (size_t)blocks.back() % ARENA_ALIGNMENT;
+        next = blocks.back() + (offset ? ARENA_ALIGNMENT - offset : 0);
+        left = size;
+    }
+    void* p = next;
+    next += bytes;
+    left -= bytes;
+    return p;
+}
+
+/**
+ * Memory is only freed by Release().
+ */
+void OBJArena::Deallocate(void*, size_t) {}
+
+/**
+ * Get the bytes held by the blocks of the arena.
+ */
+size_t OBJArena::GetSizeInBytes() const {
+    return held;
+}
+
+/**
+ * Free all memory handed out by the arena.
+ */
+void OBJArena::Release() {
+    for (unsigned int i = 0; i < blocks.size(); ++i)
+        delete[] blocks[i];
+    blocks.clear();
+    next = NULL;
+    left = 0;
+    held = 0;
+}
+
+} // NS Resources
+} // NS OpenEngine
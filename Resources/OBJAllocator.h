@@ -0,0 +1,192 @@
+// OBJ loader memory allocation.
+// -------------------------------------------------------------------
+// Copyright (C) 2007 OpenEngine.dk (See AUTHORS)
+//
+// This program is free software; It is covered by the GNU General
+// Public License version 2 or any later version.
+// See the GNU General Public License for more details (see LICENSE).
+//--------------------------------------------------------------------
+
+#ifndef _OBJ_ALLOCATOR_H_
+#define _OBJ_ALLOCATOR_H_
+
+#include <Resources/DataBlock.h>
+
+#include <boost/shared_ptr.hpp>
+#include <cstddef>
+#include <new>
+#include <vector>
+
+namespace OpenEngine {
+namespace Resources {
+
+using namespace std;
+
+/**
+ * Source of memory for the OBJ loader.
+ *
+ * Memory is returned with the size it was allocated with, so
+ * allocators need not store it.
+ *
+ * @class OBJAllocator OBJAllocator.h "OBJAllocator.h"
+ */
+class OBJAllocator {
+public:
+    virtual ~OBJAllocator() {}
+    virtual void* Allocate(size_t bytes) = 0;
+    virtual void Deallocate(void* p, size_t bytes) = 0;
+};
+
+typedef boost::shared_ptr<OBJAllocator> OBJAllocatorPtr;
+
+/**
+ * Allocator backed by huge pages.
+ *
+ * Allocations of at least the threshold are mapped directly from the
+ * system and rounded up to whole huge pages, which are requested
+ * with madvise on Linux. Smaller allocations, and all allocations on
+ * other systems, come from the general heap.
+ *
+ * @class OBJHugePageAllocator OBJAllocator.h "OBJAllocator.h"
+ */
+class OBJHugePageAllocator : public OBJAllocator {
+private:
+    size_t threshold;
+
+public:
+    static const size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024; //!< bytes per huge page
+
+    OBJHugePageAllocator(size_t threshold = HUGE_PAGE_SIZE);
+    void* Allocate(size_t bytes);
+    void Deallocate(void* p, size_t bytes);
+};
+
+/**
+ * Arena handing out memory from large blocks.
+ *
+ * Deallocation does nothing, all memory is freed at once by
+ * Release() or when the arena is destroyed. The arena is meant for
+ * the temporaries of a single load and is not thread safe.
+ *
+ * @class OBJArena OBJAllocator.h "OBJAllocator.h"
+ */
+class OBJArena : public OBJAllocator {
+private:
+    size_t blockSize;
+    vector<char*> blocks;
+    char* next;
+    size_t left;
+    size_t held; //!< bytes in all blocks
+
+    // no copying, the blocks are owned
+    OBJArena(const OBJArena&);
+    OBJArena& operator=(const OBJArena&);
+
+public:
+    OBJArena(size_t blockSize);
+    ~OBJArena();
+    void* Allocate(size_t bytes);
+    void Deallocate(void* p, size_t bytes);
+    void Release();
+    size_t GetSizeInBytes() const;
+};
+
+/**
+ * Standard library allocator using an OBJAllocator, or the general
+ * heap when given NULL, so containers can live in an arena.
+ */
+template <class T>
+class OBJStlAllocator {
+public:
+    typedef T value_type;
+    typedef T* pointer;
+    typedef const T* const_pointer;
+    typedef T& reference;
+    typedef const T& const_reference;
+    typedef size_t size_type;
+    typedef ptrdiff_t difference_type;
+    template <class U> struct rebind { typedef OBJStlAllocator<U> other; };
+
+    OBJAllocator* source; //!< memory source or NULL
+
+    OBJStlAllocator(OBJAllocator* source = NULL) : source(source) {}
+    template <class U> OBJStlAllocator(const OBJStlAllocator<U>& other) : source(other.source) {}
+
+    pointer allocate(size_type n, const void* = 0) {
+        size_t bytes = n * sizeof(T);
+        return (pointer)(source ? source->Allocate(bytes) : ::operator new(bytes));
+    }
+    void deallocate(pointer p, size_type n) {
+        if (source) source->Deallocate(p, n * sizeof(T));
+        else ::operator delete(p);
+    }
+    void construct(pointer p, const T& value) { new ((void*)p) T(value); }
+    void destroy(pointer p) { p->~T(); }
+    pointer address(reference r) const { return &r; }
+    const_pointer address(const_reference r) const { return &r; }
+    size_type max_size() const { return size_t(-1) / sizeof(T); }
+
+    template <class U> bool operator==(const OBJStlAllocator<U>& other) const { return source == other.source; }
+    template <class U> bool operator!=(const OBJStlAllocator<U>& other) const { return source != other.source; }
+};
+
+/**
+ * Allocate an array from an allocator, or with new[] when given a
+ * NULL pointer.
+ */
+template <class T>
+T* OBJAllocate(OBJAllocatorPtr allocator, size_t count) {
+    if (!allocator) return new T[count];
+    return (T*)allocator->Allocate(count * sizeof(T));
+}
+
+/**
+ * Free an array allocated by OBJAllocate().
+ */
+template <class T>
+void OBJDeallocate(OBJAllocatorPtr allocator, T* p, size_t count) {
+    if (!allocator) delete[] p;
+    else if (p) allocator->Deallocate(p, count * sizeof(T));
+}
+
+/**
+ * Data block whose storage belongs to an OBJAllocator.
+ *
+ * @class OBJDataBlock OBJAllocator.h "OBJAllocator.h"
+ */
+template <unsigned int N, class T>
+class OBJDataBlock : public DataBlock<N,T> {
+private:
+    OBJAllocatorPtr allocator;
+    size_t capacity;
+
+public:
+    OBJDataBlock(unsigned int size, T* data, OBJAllocatorPtr allocator, size_t capacity)
+        : DataBlock<N,T>(size, data), allocator(allocator), capacity(capacity) {}
+
+    virtual ~OBJDataBlock() {
+        OBJDeallocate(allocator, this->data, capacity);
+        // keep the base class from deleting the storage
+        this->data = NULL;
+    }
+};
+
+/**
+ * Wrap an array allocated by OBJAllocate() in a data block.
+ *
+ * @param size Number of elements in the block
+ * @param data Array of at least size*N values
+ * @param allocator Allocator the array came from
+ * @param capacity Number of values the array was allocated with
+ */
+template <unsigned int N, class T>
+DataBlock<N,T>* OBJMakeDataBlock(unsigned int size, T* data,
+                                 OBJAllocatorPtr allocator, size_t capacity) {
+    if (!allocator) return new DataBlock<N,T>(size, data);
+    return new OBJDataBlock<N,T>(size, data, allocator, capacity);
+}
+
+} // NS Resources
+} // NS OpenEngine
+
+#endif // _OBJ_ALLOCATOR_H_
@@ -0,0 +1,225 @@
+// OBJ static batching.
+// -------------------------------------------------------------------
+// Copyright (C) 2007 OpenEngine.dk (See AUTHORS)
+//
+// This program is free software; It is covered by the GNU General
+// Public License version 2 or any later version.
+// See the GNU General Public License for more details (see LICENSE).
+//--------------------------------------------------------------------
+
+#include <Resources/OBJBatcher.h>
+#include <Resources/OBJResource.h>
+#include <Resources/OBJConversion.h>
+#include <Resources/DataBlock.h>
+#include <Geometry/GeometrySet.h>
+#include <Logging/Logger.h>
+#include <Scene/SceneNode.h>
+#include <Scene/MeshNode.h>
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace OpenEngine {
+namespace Resources {
+
+using namespace OpenEngine::Logging;
+using namespace OpenEngine::Scene;
+
+// batches use 16 bit indices
+static const unsigned int MAX_BATCH_VERTICES = 0x10000;
+
+/**
+ * Add a triangle mesh to the batch set.
+ * Meshes without vertices or indices are skipped.
+ *
+ * @param mesh Mesh to merge, must be of type TRIANGLES
+ * @param transform Transformation into batch space, with the
+ *                  translation in the last column
+ */
+void OBJBatcher::Add(MeshPtr mesh, Matrix<4,4,float> transform) {
+    if (mesh->GetType() != TRIANGLES) {
+        logger.warning << "OBJBatcher can only merge triangle meshes." << logger.end;
+        return;
+    }
+    GeometrySetPtr gs = mesh->GetGeometrySet();
+    if (!gs || !gs->GetVertices() || gs->GetVertices()->GetSize() == 0 ||
+        !mesh->GetIndices() || mesh->GetIndices()->GetSize() == 0)
+        return;
+    Source s;
+    s.mesh = mesh;
+    s.transform = transform;
+    sources.push_back(s);
+}
+
+/**
+ * Add the triangle meshes of a loaded OBJ resource.
+ * Line, point and strip meshes and instanced objects are not
+ * included. Recentered meshes are moved back by the origin of the
+ * resource, as the resource scene node does.
+ *
+ * @param resource Loaded resource
+ * @param transform Transformation into batch space
+ */
+void OBJBatcher::Add(OBJResource& resource, Matrix<4,4,float> transform) {
+    // apply the translation by the origin before the transformation
+    const Vector<3,double> origin = resource.GetOrigin();
+    for (unsigned int i = 0; i < 4; ++i)
+        transform(i,3) += transform(i,0) * origin[0] + transform(i,1) * origin[1] + transform(i,2) * origin[2];
+    vector<MeshPtr> meshes = resource.GetMeshes();
+    for (unsigned int i = 0; i < meshes.size(); ++i)
+        if (meshes[i]->GetType() == TRIANGLES)
+            Add(meshes[i], transform);
+}
+
+/**
+ * Merge the added meshes.
+ *
+ * Meshes sharing a material are merged in the order they were
+ * added. A material gets more than one batch when its meshes do not
+ * fit in 16 bit indices together.
+ *
+ * @return Scene node with a mesh node for each batch
+ */
+ISceneNode* OBJBatcher::Build() {
+    batches.clear();
+
+    // group the sources by material in the order they appear
+    vector<MaterialPtr> materials;
+    vector< vector<unsigned int> > groups;
+    for (unsigned int i = 0; i < sources.size(); ++i) {
+        MaterialPtr mat = sources[i].mesh->GetMaterial();
+        unsigned int g = std::find(materials.begin(), materials.end(), mat) - materials.begin();
+        if (g == materials.size()) {
+            materials.push_back(mat);
+            groups.push_back(vector<unsigned int>());
+        }
+        groups[g].push_back(i);
+    }
+
+    // split the groups into batches that fit the index type
+    for (unsigned int g = 0; g < groups.size(); ++g) {
+        vector<unsigned int> batch;
+        unsigned int vertices = 0;
+        for (unsigned int i = 0; i < groups[g].size(); ++i) {
+            unsigned int count = sources[groups[g][i]].mesh->GetGeometrySet()->GetVertices()->GetSize();
+            if (!batch.empty() && vertices + count > MAX_BATCH_VERTICES) {
+                Merge(batch);
+                batch.clear();
+                vertices = 0;
+            }
+            batch.push_back(groups[g][i]);
+            vertices += count;
+        }
+        if (!batch.empty()) Merge(batch);
+    }
+
+    ISceneNode* node = new SceneNode();
+    for (unsigned int i = 0; i < batches.size(); ++i)
+        node->AddNode(new MeshNode(batches[i].mesh));
+    return node;
+}
+
+/**
+ * Merge a list of sources sharing the same material into a batch.
+ * The sources are transformed and copied in parallel, each into its
+ * own part of the merged buffers.
+ */
+void OBJBatcher::Merge(const vector<unsigned int>& batch) {
+    const int count = batch.size();
+    vector<unsigned int> vertexOffset(count+1, 0), indexOffset(count+1, 0);
+    vector<float*> vs(count), ns(count), ts(count), cs(count, (float*)NULL);
+    vector<unsigned char*> bs(count, (unsigned char*)NULL);
+    vector<unsigned short*> is(count);
+    bool colored = false;
+    for (int i = 0; i < count; ++i) {
+        MeshPtr mesh = sources[batch[i]].mesh;
+        GeometrySetPtr gs = mesh->GetGeometrySet();
+        IDataBlockList texlist = gs->GetTexCoords();
+        vs[i] = (float*)gs->GetVertices()->GetVoidDataPtr();
+        ns[i] = gs->GetNormals() ? (float*)gs->GetNormals()->GetVoidDataPtr() : NULL;
+        ts[i] = texlist.empty() || !texlist.front() ? NULL : (float*)texlist.front()->GetVoidDataPtr();
+        // colours are either floats or 8 bit RGBA
+        IDataBlockPtr colors = gs->GetColors();
+        if (colors && colors->GetDimension() == 3)
+            cs[i] = (float*)colors->GetVoidDataPtr();
+        else if (colors && colors->GetDimension() == 4 &&
+                 colors->GetSizeInBytes() == colors->GetSize() * 4)
+            bs[i] = (unsigned char*)colors->GetVoidDataPtr();
+        colored = colored || cs[i] || bs[i];
+        is[i] = mesh->GetIndices()->GetData();
+        vertexOffset[i+1] = vertexOffset[i] + gs->GetVertices()->GetSize();
+        indexOffset[i+1] = indexOffset[i] + mesh->GetIndices()->GetSize();
+    }
+
+    const unsigned int vcount = vertexOffset[count], icount = indexOffset[count];
+    float* vd = new float[vcount*3];
+    float* nd = new float[vcount*3];
+    float* td = new float[vcount*2];
+    float* cd = colored ? new float[vcount*3] : NULL;
+    unsigned short* id = new unsigned short[icount];
+    OBJBatch result;
+    result.ranges.resize(count);
+
+    #pragma omp parallel for
+    for (int i = 0; i < count; ++i) {
+        const Matrix<4,4,float>& m = sources[batch[i]].transform;
+        // normals use the cofactors so they stay perpendicular under
+        // non-uniform scaling
+        const OBJConversion conversion(m, 1.0f, false);
+        OBJBatchRange& range = result.ranges[i];
+        range.source = batch[i];
+        range.indexOffset = indexOffset[i];
+        range.indexCount = indexOffset[i+1] - indexOffset[i];
+        range.min = Vector<3,float>(FLT_MAX);
+        range.max = Vector<3,float>(-FLT_MAX);
+        for (unsigned int v = 0; v < vertexOffset[i+1] - vertexOffset[i]; ++v) {
+            const float* p = &vs[i][v*3];
+            float* out = &vd[(vertexOffset[i] + v)*3];
+            for (unsigned int r = 0; r < 3; ++r) {
+                out[r] = m(r,0) * p[0] + m(r,1) * p[1] + m(r,2) * p[2] + m(r,3);
+                range.min[r] = std::min(range.min[r], out[r]);
+                range.max[r] = std::max(range.max[r], out[r]);
+            }
+            float* n = &nd[(vertexOffset[i] + v)*3];
+            if (ns[i]) {
+                std::copy(&ns[i][v*3], &ns[i][v*3] + 3, n);
+                conversion.Normal(n);
+                float len = n[0] * n[0] + n[1] * n[1] + n[2] * n[2];
+                len = len > 0.0f ? 1.0f / sqrt(len) : 0.0f;
+                for (unsigned int r = 0; r < 3; ++r)
+                    n[r] *= len;
+            } else
+                n[0] = n[1] = n[2] = 0.0f;
+            float* t = &td[(vertexOffset[i] + v)*2];
+            t[0] = ts[i] ? ts[i][v*2] : 0.0f;
+            t[1] = ts[i] ? ts[i][v*2+1] : 0.0f;
+            if (!cd) continue;
+            float* c = &cd[(vertexOffset[i] + v)*3];
+            for (unsigned int r = 0; r < 3; ++r)
+                c[r] = cs[i] ? cs[i][v*3+r] : bs[i] ? bs[i][v*4+r] / 255.0f : 1.0f;
+        }
+        for (unsigned int k = 0; k < range.indexCount; ++k)
+            id[indexOffset[i] + k] = is[i][k] + vertexOffset[i];
+    }
+
+    IDataBlockList texlist;
+    texlist.push_back(Float2DataBlockPtr(new DataBlock<2,float>(vcount, td)));
+    GeometrySetPtr gs = GeometrySetPtr(new GeometrySet(Float3DataBlockPtr(new DataBlock<3,float>(vcount, vd)),
+                                                       Float3DataBlockPtr(new DataBlock<3,float>(vcount, nd)),
+                                                       texlist, cd ? Float3DataBlockPtr(new DataBlock<3,float>(vcount, cd))
+                                                                   : Float3DataBlockPtr()));
+    result.mesh = MeshPtr(new Mesh(IndicesPtr(new Indices(icount, id)), TRIANGLES, gs,
+                                   sources[batch[0]].mesh->GetMaterial()));
+    batches.push_back(result);
+}
+
+/**
+ * Get the batches created by the last call to Build().
+ */
+const vector<OBJBatch>& OBJBatcher::GetBatches() {
+    return batches;
+}
+
+} // NS Resources
+} // NS OpenEngine
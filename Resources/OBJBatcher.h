@@ -0,0 +1,90 @@
+// OBJ static batching.
+// -------------------------------------------------------------------
+// Copyright (C) 2007 OpenEngine.dk (See AUTHORS)
+//
+// This program is free software; It is covered by the GNU General
+// Public License version 2 or any later version.
+// See the GNU General Public License for more details (see LICENSE).
+//--------------------------------------------------------------------
+
+#ifndef _OBJ_BATCHER_H_
+#define _OBJ_BATCHER_H_
+
+#include <Geometry/Mesh.h>
+#include <Math/Matrix.h>
+#include <Math/Vector.h>
+#include <Scene/ISceneNode.h>
+
+#include <vector>
+
+namespace OpenEngine {
+namespace Resources {
+
+using namespace OpenEngine::Geometry;
+using OpenEngine::Math::Matrix;
+using OpenEngine::Math::Vector;
+using OpenEngine::Scene::ISceneNode;
+using namespace std;
+
+class OBJResource;
+
+/**
+ * The part of a batch that came from one source mesh.
+ */
+struct OBJBatchRange {
+    unsigned int source;      //!< number of the source, in the order added
+    unsigned int indexOffset; //!< first index of the source in the batch
+    unsigned int indexCount;  //!< number of indices of the source
+    Vector<3,float> min;      //!< smallest corner of the transformed source
+    Vector<3,float> max;      //!< largest corner of the transformed source
+};
+
+/**
+ * A merged mesh and the ranges it was built from.
+ */
+struct OBJBatch {
+    MeshPtr mesh;                  //!< the merged mesh
+    vector<OBJBatchRange> ranges;  //!< one range per source mesh
+};
+
+/**
+ * Static batching of OBJ meshes.
+ *
+ * Triangle meshes added with a transformation are merged into one
+ * mesh per material, with the vertices transformed into the batch
+ * space. The range each source occupies in the merged index buffer
+ * is kept along with its bounds, so sources can still be culled
+ * individually by drawing sub ranges.
+ *
+ * @code
+ * OBJBatcher batcher;
+ * batcher.Add(*chair, chairTransform);
+ * batcher.Add(*table, tableTransform);
+ * root->AddNode(batcher.Build());
+ * @endcode
+ *
+ * @class OBJBatcher OBJBatcher.h "OBJBatcher.h"
+ */
+class OBJBatcher {
+private:
+    struct Source {
+        MeshPtr mesh;
+        Matrix<4,4,float> transform;
+    };
+
+    vector<Source> sources;
+    vector<OBJBatch> batches;
+
+    void Merge(const vector<unsigned int>& batch);
+
+public:
+    void Add(MeshPtr mesh, Matrix<4,4,float> transform);
+    void Add(OBJResource& resource, Matrix<4,4,float> transform);
+    ISceneNode* Build();
+    const vector<OBJBatch>& GetBatches();
+};
+
+} // NS Resources
+} // NS OpenEngine
+
+#endif // _OBJ_BATCHER_H_
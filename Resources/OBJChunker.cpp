@@ -0,0 +1,260 @@
+// OBJ spatial chunking.
+// -------------------------------------------------------------------
+// Copyright (C) 2007 OpenEngine.dk (See AUTHORS)
+//
+// This program is free software; It is covered by the GNU General
+// Public License version 2 or any later version.
+// See the GNU General Public License for more details (see LICENSE).
+//--------------------------------------------------------------------
+
+#include <Resources/OBJChunker.h>
+#include <Resources/OBJMeshData.h>
+#include <Resources/DataBlock.h>
+#include <Geometry/GeometrySet.h>
+#include <Scene/SceneNode.h>
+#include <Scene/MeshNode.h>
+
+#include <algorithm>
+#include <cfloat>
+
+namespace OpenEngine {
+namespace Resources {
+
+using namespace OpenEngine::Scene;
+
+// the chunk meshes use 16 bit indices and the vertices of a chunk
+// may all be unique, so this is the largest safe chunk size
+static const unsigned int MAX_CHUNK_TRIANGLES = 0xFFFF / 3;
+
+/**
+ * Orders triangle numbers by the material they use.
+ */
+class MaterialOrder {
+    const unsigned int* materials;
+public:
+    MaterialOrder(const unsigned int* materials) : materials(materials) {}
+    bool operator()(unsigned int a, unsigned int b) const {
+        return materials[a] < materials[b];
+    }
+};
+
+/**
+ * Orders triangle numbers by one coordinate of their centroids.
+ */
+class CentroidOrder {
+    const float* centroids;
+    unsigned int axis;
+public:
+    CentroidOrder(const float* centroids, unsigned int axis)
+        : centroids(centroids), axis(axis) {}
+    bool operator()(unsigned int a, unsigned int b) const {
+        return centroids[a*3+axis] < centroids[b*3+axis];
+    }
+};
+
+OBJChunker::OBJChunker(OBJMeshData& data, const vector<MaterialPtr>& materials,
+                       unsigned int maxTriangles, unsigned int maxDepth,
+                       vector<OBJChunk>& chunks)
+    : data(data)
+    , materials(materials)
+    , maxTriangles(std::max(1u, std::min(maxTriangles, MAX_CHUNK_TRIANGLES)))
+    , maxDepth(maxDepth)
+    , chunks(chunks)
+    , centroids(data.triangleCount*3)
+    , remap(data.vertexCount, ~0u) {}
+
+/**
+ * Partition OBJ triangle data into an octree of meshes.
+ *
+ * @param data Triangle data to partition
+ * @param materials Materials referenced by the triangles
+ * @param maxTriangles Largest number of triangles in a leaf
+ * @param maxDepth Largest depth of the octree
+ * @param chunks List the created chunks are appended to
+ * @return Root of the scene subtree holding the chunks
+ */
+ISceneNode* OBJChunker::Build(OBJMeshData& data,
+                              const vector<MaterialPtr>& materials,
+                              unsigned int maxTriangles,
+                              unsigned int maxDepth,
+                              vector<OBJChunk>& chunks) {
+    OBJChunker chunker(data, materials, maxTriangles, maxDepth, chunks);
+    const int count = data.triangleCount;
+    vector<unsigned int> tris(count);
+
+    #pragma omp parallel for
+    for (int t = 0; t < count; ++t) {
+        for (unsigned int j = 0; j < 3; ++j)
+            chunker.centroids[t*3+j] = (data.vertices[data.indices[t*3]*3+j]
+                                        + data.vertices[data.indices[t*3+1]*3+j]
+                                        + data.vertices[data.indices[t*3+2]*3+j]) / 3.0f;
+        tris[t] = t;
+    }
+
+    if (count == 0) return new SceneNode();
+    return chunker.Split(&tris[0], count, 0);
+}
+
+/**
+ * Get the bounds of the centroids of a set of triangles.
+ */
+void OBJChunker::Bounds(const unsigned int* tris, unsigned int count,
+                        Vector<3,float>& min, Vector<3,float>& max) {
+    min = Vector<3,float>(FLT_MAX);
+    max = Vector<3,float>(-FLT_MAX);
+    for (unsigned int i = 0; i < count; ++i)
+        for (unsigned int j = 0; j < 3; ++j) {
+            min[j] = std::min(min[j], centroids[tris[i]*3+j]);
+            max[j] = std::max(max[j], centroids[tris[i]*3+j]);
+        }
+}
+
+/**
+ * Recursively split a set of triangles into the eight octants of
+ * the bounds of their centroids. Sets that reach the depth limit,
+ * or cannot be split by octant, are split by count instead so no
+ * leaf holds more than maxTriangles.
+ */
+ISceneNode* OBJChunker::Split(unsigned int* tris, unsigned int count,
+                              unsigned int depth) {
+    if (count <= maxTriangles)
+        return BuildLeaf(tris, count);
+    Vector<3,float> min, max;
+    Bounds(tris, count, min, max);
+    bool flat = true;
+    for (unsigned int j = 0; j < 3; ++j)
+        flat = flat && max[j] <= min[j];
+    if (depth >= maxDepth || flat)
+        return SplitMedian(tris, count, min, max);
+
+    // counting sort the triangles by octant
+    Vector<3,float> mid = (min + max) * 0.5f;
+    vector<unsigned char> octant(count);
+    unsigned int offset[9] = { 0 };
+    for (unsigned int i = 0; i < count; ++i) {
+        const float* c = &centroids[tris[i]*3];
+        octant[i] = (c[0] > mid[0]) | ((c[1] > mid[1]) << 1) | ((c[2] > mid[2]) << 2);
+        offset[octant[i] + 1]++;
+    }
+    for (unsigned int o = 0; o < 8; ++o)
+        offset[o+1] += offset[o];
+
+    // bounds so thin that the midpoint rounds to a side put all
+    // centroids in one octant
+    for (unsigned int o = 0; o < 8; ++o)
+        if (offset[o+1] - offset[o] == count)
+            return SplitMedian(tris, count, min, max);
+
+    vector<unsigned int> sorted(count);
+    unsigned int pos[8];
+    std::copy(offset, offset + 8, pos);
+    for (unsigned int i = 0; i < count; ++i)
+        sorted[pos[octant[i]]++] = tris[i];
+    std::copy(sorted.begin(), sorted.end(), tris);
+
+    ISceneNode* node = new SceneNode();
+    for (unsigned int o = 0; o < 8; ++o) {
+        unsigned int n = offset[o+1] - offset[o];
+        if (n > 0) node->AddNode(Split(tris + offset[o], n, depth + 1));
+    }
+    return node;
+}
+
+/**
+ * Split a set of triangles in two halves at the median centroid
+ * along the longest side of the bounds, until the halves fit in a
+ * leaf.
+ */
+ISceneNode* OBJChunker::SplitMedian(unsigned int* tris, unsigned int count,
+                                    Vector<3,float> min, Vector<3,float> max) {
+    if (count <= maxTriangles)
+        return BuildLeaf(tris, count);
+    Vector<3,float> extent = max - min;
+    unsigned int axis = 0;
+    for (unsigned int j = 1; j < 3; ++j)
+        if (extent[j] > extent[axis]) axis = j;
+    const unsigned int half = count / 2;
+    std::nth_element(tris, tris + half, tris + count, CentroidOrder(&centroids[0], axis));
+
+    ISceneNode* node = new SceneNode();
+    Vector<3,float> cmin, cmax;
+    Bounds(tris, half, cmin, cmax);
+    node->AddNode(SplitMedian(tris, half, cmin, cmax));
+    Bounds(tris + half, count - half, cmin, cmax);
+    node->AddNode(SplitMedian(tris + half, count - half, cmin, cmax));
+    return node;
+}
+
+/**
+ * Create the meshes of an octree leaf, one for each material.
+ */
+ISceneNode* OBJChunker::BuildLeaf(unsigned int* tris, unsigned int count) {
+    std::stable_sort(tris, tris + count, MaterialOrder(data.materials));
+    vector<ISceneNode*> nodes;
+    unsigned int begin = 0;
+    while (begin < count) {
+        unsigned int end = begin + 1;
+        while (end < count && data.materials[tris[end]] == data.materials[tris[begin]])
+            ++end;
+        OBJChunk chunk;
+        chunk.mesh = BuildMesh(tris + begin, end - begin, chunk);
+        chunks.push_back(chunk);
+        nodes.push_back(new MeshNode(chunk.mesh));
+        begin = end;
+    }
+    if (nodes.size() == 1) return nodes[0];
+    ISceneNode* node = new SceneNode();
+    for (unsigned int i = 0; i < nodes.size(); ++i)
+        node->AddNode(nodes[i]);
+    return node;
+}
+
+/**
+ * Copy the vertices used by a set of triangles into a new mesh.
+ * All the triangles must use the same material.
+ */
+MeshPtr OBJChunker::BuildMesh(unsigned int* tris, unsigned int count,
+                              OBJChunk& chunk) {
+    vector<unsigned int> used;
+    unsigned short* id = new unsigned short[count*3];
+    for (unsigned int i = 0; i < count; ++i)
+        for (unsigned int k = 0; k < 3; ++k) {
+            unsigned int v = data.indices[tris[i]*3+k];
+            if (remap[v] == ~0u) {
+                remap[v] = used.size();
+                used.push_back(v);
+            }
+            id[i*3+k] = remap[v];
+        }
+
+    const unsigned int vcount = used.size();
+    float* vd = new float[vcount*3];
+    float* nd = new float[vcount*3];
+    float* td = new float[vcount*2];
+    chunk.min = Vector<3,float>(FLT_MAX);
+    chunk.max = Vector<3,float>(-FLT_MAX);
+    for (unsigned int i = 0; i < vcount; ++i) {
+        unsigned int v = used[i];
+        for (unsigned int j = 0; j < 3; ++j) {
+            vd[i*3+j] = data.vertices[v*3+j];
+            nd[i*3+j] = data.normals[v*3+j];
+            chunk.min[j] = std::min(chunk.min[j], vd[i*3+j]);
+            chunk.max[j] = std::max(chunk.max[j], vd[i*3+j]);
+        }
+        td[i*2]   = data.texcoords[v*2];
+        td[i*2+1] = data.texcoords[v*2+1];
+        // reset the shared remap table for the next chunk
+        remap[v] = ~0u;
+    }
+
+    IDataBlockList texlist;
+    texlist.push_back(Float2DataBlockPtr(new DataBlock<2,float>(vcount, td)));
+    GeometrySetPtr gs = GeometrySetPtr(new GeometrySet(Float3DataBlockPtr(new DataBlock<3,float>(vcount, vd)),
+                                                       Float3DataBlockPtr(new DataBlock<3,float>(vcount, nd)),
+                                                       texlist, data.ColorBlock(&used[0], vcount)));
+    return MeshPtr(new Mesh(IndicesPtr(new Indices(count*3, id)), TRIANGLES, gs,
+                            materials[data.materials[tris[0]]]));
+}
+
+} // NS Resources
+} // NS OpenEngine
@@ -0,0 +1,83 @@
+// OBJ spatial chunking.
+// -------------------------------------------------------------------
+// Copyright (C) 2007 OpenEngine.dk (See AUTHORS)
+//
+// This program is free software; It is covered by the GNU General
+// Public License version 2 or any later version.
+// See the GNU General Public License for more details (see LICENSE).
+//--------------------------------------------------------------------
+
+#ifndef _OBJ_CHUNKER_H_
+#define _OBJ_CHUNKER_H_
+
+#include <Geometry/Material.h>
+#include <Geometry/Mesh.h>
+#include <Math/Vector.h>
+#include <Scene/ISceneNode.h>
+
+#include <vector>
+
+namespace OpenEngine {
+namespace Resources {
+
+using namespace OpenEngine::Geometry;
+using OpenEngine::Math::Vector;
+using OpenEngine::Scene::ISceneNode;
+using namespace std;
+
+class OBJMeshData;
+
+/**
+ * A cullable piece of a chunked OBJ mesh.
+ */
+struct OBJChunk {
+    Vector<3,float> min;   //!< smallest corner of the chunk bounds
+    Vector<3,float> max;   //!< largest corner of the chunk bounds
+    MeshPtr mesh;          //!< the chunk mesh
+};
+
+/**
+ * Octree partitioning of OBJ triangle data.
+ *
+ * The triangles are split by their centroids until each octree leaf
+ * holds at most a given number of triangles. At the depth limit, and
+ * where the centroids cannot be told apart by octant, sets are halved
+ * at the median centroid instead, so the limit always holds. Every
+ * leaf gets one mesh per material used in it, with its own compact
+ * vertex data, while the materials themselves are shared between the
+ * leaves.
+ *
+ * @class OBJChunker OBJChunker.h "OBJChunker.h"
+ */
+class OBJChunker {
+private:
+    OBJMeshData& data;
+    const vector<MaterialPtr>& materials;
+    unsigned int maxTriangles, maxDepth;
+    vector<OBJChunk>& chunks;
+    vector<float> centroids;
+    vector<unsigned int> remap;
+
+    OBJChunker(OBJMeshData& data, const vector<MaterialPtr>& materials,
+               unsigned int maxTriangles, unsigned int maxDepth,
+               vector<OBJChunk>& chunks);
+    void Bounds(const unsigned int* tris, unsigned int count,
+                Vector<3,float>& min, Vector<3,float>& max);
+    ISceneNode* Split(unsigned int* tris, unsigned int count, unsigned int depth);
+    ISceneNode* SplitMedian(unsigned int* tris, unsigned int count,
+                            Vector<3,float> min, Vector<3,float> max);
+    ISceneNode* BuildLeaf(unsigned int* tris, unsigned int count);
+    MeshPtr BuildMesh(unsigned int* tris, unsigned int count, OBJChunk& chunk);
+
+public:
+    static ISceneNode* Build(OBJMeshData& data,
+                             const vector<MaterialPtr>& materials,
+                             unsigned int maxTriangles,
+                             unsigned int maxDepth,
+                             vector<OBJChunk>& chunks);
+};
+
+} // NS Resources
+} // NS OpenEngine
+
+#endif // _OBJ_CHUNKER_H_
@@ -0,0 +1,54 @@
+// OBJ coordinate system conversion.
+// -------------------------------------------------------------------
+// Copyright (C) 2007 OpenEngine.dk (See AUTHORS)
+//
+// This program is free software; It is covered by the GNU General
+// Public License version 2 or any later version.
+// See the GNU General Public License for more details (see LICENSE).
+//--------------------------------------------------------------------
+
+#include <Resources/OBJConversion.h>
+
+namespace OpenEngine {
+namespace Resources {
+
+/**
+ * Combine the conversion steps into one transformation.
+ *
+ * @param transform Transformation applied last, in column vector
+ *                  convention with the translation in the last column
+ * @param scale Uniform scale, e.g. 0.01 for centimeters to meters
+ * @param swapYZ Swap the y and z axes
+ */
+OBJConversion::OBJConversion(const Matrix<4,4,float>& transform, float scale, bool swapYZ) {
+    // the columns of the linear part pick up the swap and the scale
+    for (unsigned int i = 0; i < 3; ++i) {
+        for (unsigned int j = 0; j < 3; ++j)
+            position[i][swapYZ && j > 0 ? 3 - j : j] = transform(i,j) * scale;
+        position[i][3] = transform(i,3);
+    }
+
+    // cofactors of the linear part, with the sign of the determinant
+    // so mirroring does not turn the normals inside out
+    double det = 0.0;
+    for (unsigned int i = 0; i < 3; ++i)
+        for (unsigned int j = 0; j < 3; ++j) {
+            const unsigned int i1 = (i+1) % 3, i2 = (i+2) % 3;
+            const unsigned int j1 = (j+1) % 3, j2 = (j+2) % 3;
+            normal[i][j] = position[i1][j1] * position[i2][j2]
+                - position[i1][j2] * position[i2][j1];
+            if (i == 0) det += position[0][j] * normal[0][j];
+        }
+    if (det < 0.0)
+        for (unsigned int i = 0; i < 3; ++i)
+            for (unsigned int j = 0; j < 3; ++j)
+                normal[i][j] = -normal[i][j];
+
+    identity = true;
+    for (unsigned int i = 0; i < 3; ++i)
+        for (unsigned int j = 0; j < 4; ++j)
+            identity = identity && position[i][j] == (i == j ? 1.0 : 0.0);
+}
+
+} // NS Resources
+} // NS OpenEngine
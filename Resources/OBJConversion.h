@@ -0,0 +1,75 @@
+// OBJ coordinate system conversion.
+// -------------------------------------------------------------------
+// Copyright (C) 2007 OpenEngine.dk (See AUTHORS)
+//
+// This program is free software; It is covered by the GNU General
+// Public License version 2 or any later version.
+// See the GNU General Public License for more details (see LICENSE).
+//--------------------------------------------------------------------
+
+#ifndef _OBJ_CONVERSION_H_
+#define _OBJ_CONVERSION_H_
+
+#include <Math/Matrix.h>
+
+namespace OpenEngine {
+namespace Resources {
+
+using OpenEngine::Math::Matrix;
+
+/**
+ * Conversion of positions and normals to another coordinate system.
+ *
+ * The conversion first swaps the y and z axes if requested, then
+ * scales and finally applies the transformation matrix. Positions are
+ * converted in double precision. Normals are converted by the
+ * cofactor matrix of the linear part, which is the inverse transpose
+ * up to scale, so non-uniform scaling keeps them perpendicular to
+ * the surface.
+ *
+ * @class OBJConversion OBJConversion.h "OBJConversion.h"
+ */
+class OBJConversion {
+private:
+    double position[3][4]; //!< position transformation, row major
+    float normal[3][3];    //!< normal transformation, row major
+    bool identity;         //!< the conversion does nothing
+
+public:
+    OBJConversion(const Matrix<4,4,float>& transform, float scale, bool swapYZ);
+
+    /**
+     * Test if the conversion leaves everything as it is.
+     */
+    bool IsIdentity() const {
+        return identity;
+    }
+
+    /**
+     * Convert a position in place.
+     */
+    void Position(double p[3]) const {
+        if (identity) return;
+        double r[3];
+        for (unsigned int i = 0; i < 3; ++i)
+            r[i] = position[i][0] * p[0] + position[i][1] * p[1]
+                + position[i][2] * p[2] + position[i][3];
+        p[0] = r[0]; p[1] = r[1]; p[2] = r[2];
+    }
+
+    /**
+     * Convert a normal in place. The result is not normalized.
+     */
+    void Normal(float n[3]) const {
+        if (identity) return;
+        float r[3];
+        for (unsigned int i = 0; i < 3; ++i)
+            r[i] = normal[i][0] * n[0] + normal[i][1] * n[1] + normal[i][2] * n[2];
+        n[0] = r[0]; n[1] = r[1]; n[2] = r[2];
+    }
+};
+
+} // NS Resources
+} // NS OpenEngine
+
+#endif // _OBJ_CONVERSION_H_
@@ -0,0 +1,259 @@
+// OBJ convex hull generation.
+// -------------------------------------------------------------------
+// Copyright (C) 2007 OpenEngine.dk (See AUTHORS)
+//
+// This program is free software; It is covered by the GNU General
+// Public License version 2 or any later version.
+// See the GNU General Public License for more details (see LICENSE).
+//--------------------------------------------------------------------
+
+#include <Resources/OBJConvexHull.h>
+#include <Resources/OBJMeshData.h>
+#include <Math/Vector.h>
+
+#include <boost/cstdint.hpp>
+#include <boost/unordered_map.hpp>
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace OpenEngine {
+namespace Resources {
+
+using OpenEngine::Math::Vector;
+using boost::uint64_t;
+
+/**
+ * A face of a hull under construction.
+ */
+struct HullFace {
+    unsigned int v[3];            //!< corners, counter-clockwise from outside
+    Vector<3,double> normal;       //!< outward unit normal
+    double offset;                //!< plane offset along the normal
+    vector<unsigned int> outside; //!< points in front of the face
+    bool alive;                   //!< the face is part of the hull
+};
+
+/**
+ * Get the key of a directed edge.
+ */
+static uint64_t EdgeKey(unsigned int a, unsigned int b) {
+    return ((uint64_t)a << 32) | b;
+}
+
+/**
+ * Get a point as a vector.
+ */
+static Vector<3,double> Point(const double* points, unsigned int i) {
+    return Vector<3,double>(points[i*3], points[i*3+1], points[i*3+2]);
+}
+
+/**
+ * Get the signed distance of a point to the plane of a face.
+ */
+static double Distance(const HullFace& f, const double* points, unsigned int i) {
+    return f.normal * Point(points, i) - f.offset;
+}
+
+/**
+ * Create a face through three points.
+ */
+static HullFace MakeFace(const double* points, unsigned int a, unsigned int b, unsigned int c) {
+    HullFace f;
+    f.v[0] = a; f.v[1] = b; f.v[2] = c;
+    Vector<3,double> pa = Point(points, a);
+    f.normal = (Point(points, b) - pa) % (Point(points, c) - pa);
+    if (f.normal.GetLength() > 0.0) f.normal.Normalize();
+    f.offset = f.normal * pa;
+    f.alive = true;
+    return f;
+}
+
+/**
+ * Compute the convex hull of a set of points.
+ *
+ * @param points Positions, three floats per point
+ * @param count Number of points
+ * @param hull Set to the hull vertices and triangles
+ * @return False if the points are too flat to enclose a volume
+ */
+bool OBJConvexHull::Compute(const float* points, unsigned int count, OBJHull& hull) {
+    hull.vertices.clear();
+    hull.indices.clear();
+    if (count < 4) return false;
+
+    // extreme points along the axes
+    unsigned int ext[6] = { 0, 0, 0, 0, 0, 0 };
+    for (unsigned int i = 0; i < count; ++i)
+        for (unsigned int j = 0; j < 3; ++j) {
+            if (points[i*3+j] < points[ext[j*2]*3+j]) ext[j*2] = i;
+            if (points[i*3+j] > points[ext[j*2+1]*3+j]) ext[j*2+1] = i;
+        }
+
+    // work around the center in double precision, so the tolerance
+    // only depends on the size of the object and not its position
+    double center[3], scale = 0.0;
+    for (unsigned int j = 0; j < 3; ++j) {
+        center[j] = 0.5 * ((double)points[ext[j*2]*3+j] + points[ext[j*2+1]*3+j]);
+        scale += points[ext[j*2+1]*3+j] - center[j];
+    }
+    vector<double> local(count * 3);
+    for (unsigned int i = 0; i < count * 3; ++i)
+        local[i] = points[i] - center[i % 3];
+    const double eps = 3.0 * FLT_EPSILON * scale;
+    const double* pts = &local[0];
+
+    // initial tetrahedron from the two most distant extremes, the
+    // point farthest from their line and the point farthest from the
+    // plane of the three
+    unsigned int a = 0, b = 0, c = 0, d = 0;
+    double best = 0.0;
+    for (unsigned int i = 0; i < 6; ++i)
+        for (unsigned int j = i + 1; j < 6; ++j) {
+            double dist = (Point(pts, ext[i]) - Point(pts, ext[j])).GetLength();
+            if (dist > best) { best = dist; a = ext[i]; b = ext[j]; }
+        }
+    if (best <= eps) return false;
+    Vector<3,double> ab = Point(pts, b) - Point(pts, a);
+    best = 0.0;
+    for (unsigned int i = 0; i < count; ++i) {
+        double dist = ((Point(pts, i) - Point(pts, a)) % ab).GetLength() / ab.GetLength();
+        if (dist > best) { best = dist; c = i; }
+    }
+    if (best <= eps) return false;
+    HullFace base = MakeFace(pts, a, b, c);
+    best = 0.0;
+    for (unsigned int i = 0; i < count; ++i) {
+        double dist = fabs(Distance(base, pts, i));
+        if (dist > best) { best = dist; d = i; }
+    }
+    if (best <= eps) return false;
+
+    // faces of the tetrahedron facing away from the opposite corner
+    vector<HullFace> faces;
+    const unsigned int tet[4][4] = { { a, b, c, d }, { a, d, b, c }, { b, d, c, a }, { c, d, a, b } };
+    for (unsigned int i = 0; i < 4; ++i) {
+        HullFace f = MakeFace(pts, tet[i][0], tet[i][1], tet[i][2]);
+        if (Distance(f, pts, tet[i][3]) > 0.0)
+            f = MakeFace(pts, tet[i][0], tet[i][2], tet[i][1]);
+        faces.push_back(f);
+    }
+    for (unsigned int i = 0; i < count; ++i) {
+        if (i == a || i == b || i == c || i == d) continue;
+        for (unsigned int k = 0; k < faces.size(); ++k)
+            if (Distance(faces[k], pts, i) > eps) {
+                faces[k].outside.push_back(i);
+                break;
+            }
+    }
+    boost::unordered_map<uint64_t, unsigned int> edgeFace;
+    for (unsigned int k = 0; k < faces.size(); ++k)
+        for (unsigned int e = 0; e < 3; ++e)
+            edgeFace[EdgeKey(faces[k].v[e], faces[k].v[(e+1)%3])] = k;
+
+    // new faces are appended, so one pass handles them all
+    vector<unsigned int> visible, orphans, stamp;
+    vector<pair<unsigned int, unsigned int> > horizon;
+    for (unsigned int k = 0; k < faces.size(); ++k) {
+        if (!faces[k].alive || faces[k].outside.empty()) continue;
+        unsigned int p = faces[k].outside[0];
+        double farthest = Distance(faces[k], pts, p);
+        for (unsigned int i = 1; i < faces[k].outside.size(); ++i) {
+            double dist = Distance(faces[k], pts, faces[k].outside[i]);
+            if (dist > farthest) { farthest = dist; p = faces[k].outside[i]; }
+        }
+
+        // the faces p can see form a connected region around face k,
+        // the edges leading out of it are the horizon
+        stamp.resize(faces.size(), 0);
+        visible.assign(1, k);
+        stamp[k] = k + 1;
+        horizon.clear();
+        for (unsigned int i = 0; i < visible.size(); ++i) {
+            const HullFace& f = faces[visible[i]];
+            for (unsigned int e = 0; e < 3; ++e) {
+                unsigned int u = f.v[e], w = f.v[(e+1)%3];
+                unsigned int n = edgeFace[EdgeKey(w, u)];
+                if (stamp[n] == k + 1) continue;
+                if (Distance(faces[n], pts, p) > eps) {
+                    stamp[n] = k + 1;
+                    visible.push_back(n);
+                } else
+                    horizon.push_back(make_pair(u, w));
+            }
+        }
+
+        orphans.clear();
+        for (unsigned int i = 0; i < visible.size(); ++i) {
+            HullFace& f = faces[visible[i]];
+            f.alive = false;
+            for (unsigned int j = 0; j < f.outside.size(); ++j)
+                if (f.outside[j] != p) orphans.push_back(f.outside[j]);
+            vector<unsigned int>().swap(f.outside);
+        }
+
+        // fan from the horizon to the new point
+        const unsigned int first = faces.size();
+        for (unsigned int i = 0; i < horizon.size(); ++i) {
+            faces.push_back(MakeFace(pts, horizon[i].first, horizon[i].second, p));
+            const HullFace& f = faces.back();
+            for (unsigned int e = 0; e < 3; ++e)
+                edgeFace[EdgeKey(f.v[e], f.v[(e+1)%3])] = faces.size() - 1;
+        }
+        for (unsigned int i = 0; i < orphans.size(); ++i)
+            for (unsigned int n = first; n < faces.size(); ++n)
+                if (Distance(faces[n], pts, orphans[i]) > eps) {
+                    faces[n].outside.push_back(orphans[i]);
+                    break;
+                }
+    }
+
+    // compact the used points
+    vector<unsigned int> remap(count, ~0u);
+    for (unsigned int k = 0; k < faces.size(); ++k) {
+        if (!faces[k].alive) continue;
+        for (unsigned int e = 0; e < 3; ++e) {
+            unsigned int v = faces[k].v[e];
+            if (remap[v] == ~0u) {
+                remap[v] = hull.vertices.size() / 3;
+                hull.vertices.insert(hull.vertices.end(), points + v*3, points + v*3 + 3);
+            }
+            hull.indices.push_back(remap[v]);
+        }
+    }
+    return true;
+}
+
+/**
+ * Compute the convex hull of each object in parallel.
+ * Objects too flat to enclose a volume get no hull.
+ *
+ * @param data Triangle data of the objects
+ * @param objects First triangle of each object, in increasing order
+ * @param hulls Set to the hulls
+ */
+void OBJConvexHull::Build(const OBJMeshData& data, const vector<unsigned int>& objects,
+                          vector<OBJHull>& hulls) {
+    const int count = objects.size();
+    vector<OBJHull> all(count);
+    vector<char> found(count, 0);
+    #pragma omp parallel for schedule(dynamic)
+    for (int i = 0; i < count; ++i) {
+        unsigned int begin = objects[i] * 3;
+        unsigned int end = i+1 < count ? objects[i+1] * 3 : data.triangleCount * 3;
+        vector<unsigned int> used(data.indices + begin, data.indices + end);
+        std::sort(used.begin(), used.end());
+        used.erase(std::unique(used.begin(), used.end()), used.end());
+        vector<float> points(used.size() * 3);
+        for (unsigned int j = 0; j < used.size(); ++j)
+            std::copy(data.vertices + used[j]*3, data.vertices + used[j]*3 + 3, &points[j*3]);
+        all[i].object = i;
+        found[i] = !used.empty() && Compute(&points[0], used.size(), all[i]);
+    }
+    hulls.clear();
+    for (int i = 0; i < count; ++i)
+        if (found[i]) hulls.push_back(all[i]);
+}
+
+} // NS Resources
+} // NS OpenEngine
@@ -0,0 +1,52 @@
+// OBJ convex hull generation.
+// -------------------------------------------------------------------
+// Copyright (C) 2007 OpenEngine.dk (See AUTHORS)
+//
+// This program is free software; It is covered by the GNU General
+// Public License version 2 or any later version.
+// See the GNU General Public License for more details (see LICENSE).
+//--------------------------------------------------------------------
+
+#ifndef _OBJ_CONVEX_HULL_H_
+#define _OBJ_CONVEX_HULL_H_
+
+#include <vector>
+
+namespace OpenEngine {
+namespace Resources {
+
+using namespace std;
+
+class OBJMeshData;
+
+/**
+ * Convex hull of an object, e.g. for use as a collision proxy.
+ */
+struct OBJHull {
+    unsigned int object;          //!< object number in the file
+    vector<float> vertices;       //!< hull positions, three floats each
+    vector<unsigned int> indices; //!< hull triangles, counter-clockwise from outside
+};
+
+/**
+ * Quickhull convex hull computation.
+ *
+ * The hull starts as the tetrahedron of four extreme points and
+ * grows by repeatedly adding the point farthest outside a face,
+ * replacing the faces it can see with a fan to their horizon. Points
+ * within a tolerance scaled to the coordinates are treated as lying
+ * on the hull, so nearly coplanar points do not produce slivers.
+ *
+ * @class OBJConvexHull OBJConvexHull.h "OBJConvexHull.h"
+ */
+class OBJConvexHull {
+public:
+    static bool Compute(const float* points, unsigned int count, OBJHull& hull);
+    static void Build(const OBJMeshData& data, const vector<unsigned int>& objects,
+                      vector<OBJHull>& hulls);
+};
+
+} // NS Resources
+} // NS OpenEngine
+
+#endif // _OBJ_CONVEX_HULL_H_
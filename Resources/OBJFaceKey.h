@@ -0,0 +1,52 @@
+// OBJ duplicate face key.
+// -------------------------------------------------------------------
+// Copyright (C) 2007 OpenEngine.dk (See AUTHORS)
+//
+// This program is free software; It is covered by the GNU General
+// Public License version 2 or any later version.
+// See the GNU General Public License for more details (see LICENSE).
+//--------------------------------------------------------------------
+
+#ifndef _OBJ_FACE_KEY_H_
+#define _OBJ_FACE_KEY_H_
+
+#include <boost/functional/hash.hpp>
+#include <algorithm>
+#include <cstddef>
+
+namespace OpenEngine {
+namespace Resources {
+
+/**
+ * The v/vt/vn indices of a face, rotated so the smallest vertex
+ * index comes first. Rotating keeps the winding, so two faces are
+ * duplicates exactly when their keys are equal.
+ *
+ * @class OBJFaceKey OBJFaceKey.h "OBJFaceKey.h"
+ */
+struct OBJFaceKey {
+    unsigned int idx[9];
+
+    OBJFaceKey(const unsigned int* face) {
+        unsigned int first = 0;
+        if (face[3] < face[first*3]) first = 1;
+        if (face[6] < face[first*3]) first = 2;
+        for (unsigned int i = 0; i < 9; ++i)
+            idx[i] = face[(first*3 + i) % 9];
+    }
+    bool operator==(const OBJFaceKey& other) const {
+        return std::equal(idx, idx + 9, other.idx);
+    }
+};
+
+/**
+ * Hash of a face key, found by boost::hash.
+ */
+inline std::size_t hash_value(const OBJFaceKey& key) {
+    return boost::hash_range(key.idx, key.idx + 9);
+}
+
+} // NS Resources
+} // NS OpenEngine
+
+#endif // _OBJ_FACE_KEY_H_
@@ -0,0 +1,258 @@
+// OBJ instance detection.
+// -------------------------------------------------------------------
+// Copyright (C) 2007 OpenEngine.dk (See AUTHORS)
+//
+// This program is free software; It is covered by the GNU General
+// Public License version 2 or any later version.
+// See the GNU General Public License for more details (see LICENSE).
+//--------------------------------------------------------------------
+
+#include <Resources/OBJInstancer.h>
+#include <Resources/OBJMeshData.h>
+#include <Resources/DataBlock.h>
+#include <Geometry/GeometrySet.h>
+#include <Geometry/Mesh.h>
+#include <Math/Quaternion.h>
+#include <Scene/SceneNode.h>
+#include <Scene/MeshNode.h>
+#include <Scene/TransformationNode.h>
+
+#include <boost/functional/hash.hpp>
+#include <boost/unordered_map.hpp>
+#include <algorithm>
+#include <cmath>
+
+namespace OpenEngine {
+namespace Resources {
+
+using OpenEngine::Math::Quaternion;
+using namespace OpenEngine::Scene;
+
+// instanced meshes use 16 bit indices over unshared vertices
+static const unsigned int MAX_INSTANCE_TRIANGLES = 0xFFFF / 3;
+
+// corners spanning the local frame must be this many tolerances
+// apart, so the frame axes are stable under rounding noise
+static const float FRAME_SPAN = 1000.0f;
+
+// local coordinates are hashed on a grid this many tolerances wide
+static const float HASH_QUANTUM = 16.0f;
+
+OBJInstancer::OBJInstancer(OBJMeshData& data, float epsilon)
+    : data(data), epsilon(epsilon) {}
+
+/**
+ * Express a point or direction in the local frame of an object.
+ */
+Vector<3,float> OBJInstancer::Local(const Frame& frame, const float* p, bool point) {
+    Vector<3,float> d(p[0], p[1], p[2]);
+    if (point) d -= frame.origin;
+    Vector<3,float> l;
+    for (unsigned int j = 0; j < 3; ++j)
+        l[j] = frame.rot(0,j) * d[0] + frame.rot(1,j) * d[1] + frame.rot(2,j) * d[2];
+    return l;
+}
+
+/**
+ * Find the local frame of an object and hash its local geometry.
+ * Objects that are too small, flat along a line or use more than
+ * one material are left invalid.
+ */
+void OBJInstancer::ComputeFrame(Frame& frame) {
+    frame.valid = false;
+    if (frame.begin == frame.end ||
+        frame.end - frame.begin > MAX_INSTANCE_TRIANGLES) return;
+    for (unsigned int t = frame.begin + 1; t < frame.end; ++t)
+        if (data.materials[t] != data.materials[frame.begin]) return;
+
+    const float span = FRAME_SPAN * epsilon;
+    const unsigned int first = frame.begin*3, last = frame.end*3;
+    const float* p0 = &data.vertices[data.indices[first]*3];
+    Vector<3,float> o(p0[0], p0[1], p0[2]), e1, e2;
+    unsigned int c = first + 1;
+    for (; c < last; ++c) {
+        const float* p = &data.vertices[data.indices[c]*3];
+        e1 = Vector<3,float>(p[0], p[1], p[2]) - o;
+        if (e1.GetLength() > span) break;
+    }
+    if (c == last) return;
+    e1.Normalize();
+    for (++c; c < last; ++c) {
+        const float* p = &data.vertices[data.indices[c]*3];
+        e2 = Vector<3,float>(p[0], p[1], p[2]) - o;
+        if ((e1 % e2).GetLength() > span) break;
+    }
+    if (c == last) return;
+    e2 = e2 - e1 * (e1 * e2);
+    e2.Normalize();
+    Vector<3,float> e3 = e1 % e2;
+    for (unsigned int r = 0; r < 3; ++r) {
+        frame.rot(r,0) = e1[r];
+        frame.rot(r,1) = e2[r];
+        frame.rot(r,2) = e3[r];
+    }
+    frame.origin = o;
+    frame.valid = true;
+
+    const float quantum = HASH_QUANTUM * epsilon;
+    frame.hash = frame.end - frame.begin;
+    boost::hash_combine(frame.hash, data.materials[frame.begin]);
+    for (c = first; c < last; ++c) {
+        Vector<3,float> l = Local(frame, &data.vertices[data.indices[c]*3], true);
+        for (unsigned int j = 0; j < 3; ++j)
+            boost::hash_combine(frame.hash, (long)floor(l[j] / quantum + 0.5f));
+    }
+}
+
+/**
+ * Test if two objects are equal in their local frames.
+ */
+bool OBJInstancer::Congruent(Frame& a, Frame& b) {
+    if (a.end - a.begin != b.end - b.begin) return false;
+    if (data.materials[a.begin] != data.materials[b.begin]) return false;
+    const unsigned int corners = (a.end - a.begin) * 3;
+    for (unsigned int c = 0; c < corners; ++c) {
+        unsigned int va = data.indices[a.begin*3 + c], vb = data.indices[b.begin*3 + c];
+        Vector<3,float> d = Local(a, &data.vertices[va*3], true)
+            - Local(b, &data.vertices[vb*3], true);
+        Vector<3,float> n = Local(a, &data.normals[va*3], false)
+            - Local(b, &data.normals[vb*3], false);
+        if (d.GetLength() > epsilon || n.GetLength() > epsilon ||
+            fabs(data.texcoords[va*2] - data.texcoords[vb*2]) > epsilon ||
+            fabs(data.texcoords[va*2+1] - data.texcoords[vb*2+1]) > epsilon)
+            return false;
+        if (data.colors)
+            for (unsigned int j = 0; j < 3; ++j)
+                if (fabs(data.colors[va*3+j] - data.colors[vb*3+j]) > epsilon)
+                    return false;
+    }
+    return true;
+}
+
+/**
+ * Create the shared mesh of a set of congruent objects and a
+ * transformation node for each of them.
+ */
+ISceneNode* OBJInstancer::BuildInstances(const vector<unsigned int>& objects,
+                                         const vector<MaterialPtr>& materials,
+                                         vector<MeshPtr>& meshes) {
+    const Frame& rep = frames[objects[0]];
+    const unsigned int count = (rep.end - rep.begin) * 3;
+    unsigned short* id = new unsigned short[count];
+    float* vd = new float[count*3];
+    float* nd = new float[count*3];
+    float* td = new float[count*2];
+    for (unsigned int c = 0; c < count; ++c) {
+        unsigned int v = data.indices[rep.begin*3 + c];
+        id[c] = c;
+        Local(rep, &data.vertices[v*3], true).ToArray(&vd[c*3]);
+        Local(rep, &data.normals[v*3], false).ToArray(&nd[c*3]);
+        td[c*2]   = data.texcoords[v*2];
+        td[c*2+1] = data.texcoords[v*2+1];
+    }
+    IDataBlockList texlist;
+    texlist.push_back(Float2DataBlockPtr(new DataBlock<2,float>(count, td)));
+    GeometrySetPtr gs = GeometrySetPtr(new GeometrySet(Float3DataBlockPtr(new DataBlock<3,float>(count, vd)),
+                                                       Float3DataBlockPtr(new DataBlock<3,float>(count, nd)),
+                                                       texlist, data.ColorBlock(&data.indices[rep.begin*3], count)));
+    MeshPtr mesh = MeshPtr(new Mesh(IndicesPtr(new Indices(count, id)), TRIANGLES, gs,
+                                    materials[data.materials[rep.begin]]));
+    meshes.push_back(mesh);
+
+    ISceneNode* node = new SceneNode();
+    for (unsigned int i = 0; i < objects.size(); ++i) {
+        const Frame& frame = frames[objects[i]];
+        TransformationNode* trans = new TransformationNode();
+        trans->SetRotation(Quaternion<float>(frame.rot));
+        trans->SetPosition(frame.origin);
+        trans->AddNode(new MeshNode(mesh));
+        node->AddNode(trans);
+    }
+    return node;
+}
+
+/**
+ * Replace repeated objects with instances of a shared mesh.
+ *
+ * The triangles of the instanced objects are removed from the mesh
+ * data and any vertices left unused are dropped.
+ *
+ * @param data Triangle data to search
+ * @param objects First triangle of each object, in increasing order
+ * @param materials Materials referenced by the triangles
+ * @param epsilon Largest difference of local coordinates
+ * @param minCount Smallest number of copies worth instancing
+ * @param instances Set to the number of objects replaced
+ * @param meshes The shared meshes are appended here
+ * @return Node holding the instances, or NULL if none were found
+ */
+ISceneNode* OBJInstancer::Extract(OBJMeshData& data,
+                                  const vector<unsigned int>& objects,
+                                  const vector<MaterialPtr>& materials,
+                                  float epsilon, unsigned int minCount,
+                                  unsigned int& instances,
+                                  vector<MeshPtr>& meshes) {
+    instances = 0;
+    if (objects.size() < 2) return NULL;
+
+    OBJInstancer inst(data, epsilon);
+    const int count = objects.size();
+    inst.frames.resize(count);
+    #pragma omp parallel for
+    for (int i = 0; i < count; ++i) {
+        Frame& frame = inst.frames[i];
+        frame.begin = objects[i];
+        frame.end = i+1 < count ? objects[i+1] : data.triangleCount;
+        inst.ComputeFrame(frame);
+    }
+
+    // group congruent objects, hashes only pick the candidates
+    boost::unordered_map<std::size_t, vector<unsigned int> > byHash;
+    vector< vector<unsigned int> > classes;
+    for (int i = 0; i < count; ++i) {
+        Frame& frame = inst.frames[i];
+        if (!frame.valid) continue;
+        vector<unsigned int>& candidates = byHash[frame.hash];
+        unsigned int k = 0;
+        for (; k < candidates.size(); ++k)
+            if (inst.Congruent(inst.frames[classes[candidates[k]][0]], frame)) {
+                classes[candidates[k]].push_back(i);
+                break;
+            }
+        if (k == candidates.size()) {
+            candidates.push_back(classes.size());
+            classes.push_back(vector<unsigned int>(1, i));
+        }
+    }
+
+    ISceneNode* node = NULL;
+    vector<bool> removed(data.triangleCount, false);
+    for (unsigned int k = 0; k < classes.size(); ++k) {
+        if (classes[k].size() < std::max(minCount, 2u)) continue;
+        if (!node) node = new SceneNode();
+        node->AddNode(inst.BuildInstances(classes[k], materials, meshes));
+        for (unsigned int i = 0; i < classes[k].size(); ++i) {
+            const Frame& frame = inst.frames[classes[k][i]];
+            for (unsigned int t = frame.begin; t < frame.end; ++t)
+                removed[t] = true;
+        }
+        instances += classes[k].size();
+    }
+    if (!node) return NULL;
+
+    // compact the remaining triangles
+    unsigned int kept = 0;
+    for (unsigned int t = 0; t < data.triangleCount; ++t) {
+        if (removed[t]) continue;
+        for (unsigned int k = 0; k < 3; ++k)
+            data.indices[kept*3+k] = data.indices[t*3+k];
+        data.materials[kept] = data.materials[t];
+        kept++;
+    }
+    data.triangleCount = kept;
+    data.ReorderVertices();
+    return node;
+}
+
+} // NS Resources
+} // NS OpenEngine
@@ -0,0 +1,86 @@
+// OBJ instance detection.
+// -------------------------------------------------------------------
+// Copyright (C) 2007 OpenEngine.dk (See AUTHORS)
+//
+// This program is free software; It is covered by the GNU General
+// Public License version 2 or any later version.
+// See the GNU General Public License for more details (see LICENSE).
+//--------------------------------------------------------------------
+
+#ifndef _OBJ_INSTANCER_H_
+#define _OBJ_INSTANCER_H_
+
+#include <Geometry/Material.h>
+#include <Geometry/Mesh.h>
+#include <Math/Matrix.h>
+#include <Math/Vector.h>
+#include <Scene/ISceneNode.h>
+
+#include <cstddef>
+#include <vector>
+
+namespace OpenEngine {
+namespace Resources {
+
+using namespace OpenEngine::Geometry;
+using OpenEngine::Math::Matrix;
+using OpenEngine::Math::Vector;
+using OpenEngine::Scene::ISceneNode;
+using namespace std;
+
+class OBJMeshData;
+
+/**
+ * Detection of repeated objects in OBJ triangle data.
+ *
+ * Each object (the triangles of an o or g block) is expressed in a
+ * local frame spanned by its first three non-collinear corners. The
+ * local coordinates do not change under rotation and translation, so
+ * objects that are rigid copies of each other hash to the same value
+ * and can be compared directly. Every set of copies is replaced by
+ * one shared mesh in local coordinates and a transformation node per
+ * copy.
+ *
+ * The copies must list their faces and corners in the same order,
+ * which is what exporters do when they bake instances.
+ *
+ * @class OBJInstancer OBJInstancer.h "OBJInstancer.h"
+ */
+class OBJInstancer {
+private:
+    /**
+     * Local frame of an object.
+     */
+    struct Frame {
+        bool valid;               //!< the object spans a frame
+        unsigned int begin, end;  //!< triangle range of the object
+        Matrix<3,3,float> rot;    //!< local to world rotation
+        Vector<3,float> origin;   //!< local to world translation
+        std::size_t hash;         //!< hash of the local geometry
+    };
+
+    OBJMeshData& data;
+    float epsilon;
+    vector<Frame> frames;
+
+    OBJInstancer(OBJMeshData& data, float epsilon);
+    void ComputeFrame(Frame& frame);
+    Vector<3,float> Local(const Frame& frame, const float* p, bool point);
+    bool Congruent(Frame& a, Frame& b);
+    ISceneNode* BuildInstances(const vector<unsigned int>& objects,
+                               const vector<MaterialPtr>& materials,
+                               vector<MeshPtr>& meshes);
+
+public:
+    static ISceneNode* Extract(OBJMeshData& data,
+                               const vector<unsigned int>& objects,
+                               const vector<MaterialPtr>& materials,
+                               float epsilon, unsigned int minCount,
+                               unsigned int& instances,
+                               vector<MeshPtr>& meshes);
+};
+
+} // NS Resources
+} // NS OpenEngine
+
+#endif // _OBJ_INSTANCER_H_
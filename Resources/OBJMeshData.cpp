@@ -0,0 +1,296 @@
+// OBJ intermediate mesh data.
+// -------------------------------------------------------------------
+// Copyright (C) 2007 OpenEngine.dk (See AUTHORS)
+//
+// This program is free software; It is covered by the GNU General
+// Public License version 2 or any later version.
+// See the GNU General Public License for more details (see LICENSE).
+//--------------------------------------------------------------------
+
+#include <Resources/OBJMeshData.h>
+
+#include <algorithm>
+#include <cstddef>
+
+namespace OpenEngine {
+namespace Resources {
+
+/**
+ * Allocate the arrays for a mesh of the given size.
+ *
+ * @param allocator Source of the arrays, new[] is used if NULL
+ */
+OBJMeshData::OBJMeshData(unsigned int vertexCount, unsigned int triangleCount,
+                         OBJAllocatorPtr allocator)
+    : vertexCapacity(vertexCount)
+    , triangleCapacity(triangleCount)
+    , vertexCount(vertexCount)
+    , triangleCount(triangleCount)
+    , indices(OBJAllocate<unsigned int>(allocator, triangleCount*3))
+    , materials(OBJAllocate<unsigned int>(allocator, triangleCount))
+    , vertices(OBJAllocate<float>(allocator, vertexCount*3))
+    , normals(OBJAllocate<float>(allocator, vertexCount*3))
+    , texcoords(OBJAllocate<float>(allocator, vertexCount*2))
+    , colors(NULL)
+    , byteColors(false)
+    , allocator(allocator) {}
+
+/**
+ * Free the arrays that have not been handed over to data blocks.
+ */
+OBJMeshData::~OBJMeshData() {
+    OBJDeallocate(allocator, indices, triangleCapacity*3);
+    OBJDeallocate(allocator, materials, triangleCapacity);
+    FreeVertices();
+}
+
+/**
+ * Free the vertex attribute arrays.
+ */
+void OBJMeshData::FreeVertices() {
+    OBJDeallocate(allocator, vertices, vertexCapacity*3);
+    OBJDeallocate(allocator, normals, vertexCapacity*3);
+    OBJDeallocate(allocator, texcoords, vertexCapacity*2);
+    OBJDeallocate(allocator, colors, vertexCapacity*3);
+    vertices = normals = texcoords = colors = NULL;
+}
+
+/**
+ * Grow the vertex arrays.
+ * The new vertices get zero positions, normals and texture
+ * coordinates, and white colours.
+ *
+ * @param count Number of vertices to add
+ * @return Index of the first new vertex
+ */
+unsigned int OBJMeshData::AddVertices(unsigned int count) {
+    const unsigned int first = vertexCount, total = vertexCount + count;
+    float* vd = OBJAllocate<float>(allocator, total*3);
+    float* nd = OBJAllocate<float>(allocator, total*3);
+    float* td = OBJAllocate<float>(allocator, total*2);
+    float* cd = colors ? OBJAllocate<float>(allocator, total*3) : NULL;
+    std::copy(vertices, vertices + first*3, vd);
+    std::copy(normals, normals + first*3, nd);
+    std::copy(texcoords, texcoords + first*2, td);
+    std::fill(vd + first*3, vd + total*3, 0.0f);
+    std::fill(nd + first*3, nd + total*3, 0.0f);
+    std::fill(td + first*2, td + total*2, 0.0f);
+    if (cd) {
+        std::copy(colors, colors + first*3, cd);
+        std::fill(cd + first*3, cd + total*3, 1.0f);
+    }
+    FreeVertices();
+    vertices = vd;
+    normals = nd;
+    texcoords = td;
+    colors = cd;
+    vertexCapacity = vertexCount = total;
+    return first;
+}
+
+/**
+ * Allocate the colour array with all vertices white.
+ */
+void OBJMeshData::AddColors() {
+    if (colors) return;
+    colors = OBJAllocate<float>(allocator, vertexCapacity*3);
+    std::fill(colors, colors + vertexCapacity*3, 1.0f);
+}
+
+/**
+ * Exchange the contents with another mesh data object.
+ */
+void OBJMeshData::Swap(OBJMeshData& other) {
+    std::swap(vertexCapacity, other.vertexCapacity);
+    std::swap(triangleCapacity, other.triangleCapacity);
+    std::swap(vertexCount, other.vertexCount);
+    std::swap(triangleCount, other.triangleCount);
+    std::swap(indices, other.indices);
+    std::swap(materials, other.materials);
+    std::swap(vertices, other.vertices);
+    std::swap(normals, other.normals);
+    std::swap(texcoords, other.texcoords);
+    std::swap(colors, other.colors);
+    std::swap(byteColors, other.byteColors);
+    std::swap(allocator, other.allocator);
+}
+
+/**
+ * Get the bytes held by the arrays.
+ */
+size_t OBJMeshData::GetSizeInBytes() const {
+    size_t bytes = 0;
+    if (indices) bytes += triangleCapacity * 3 * sizeof(unsigned int);
+    if (materials) bytes += triangleCapacity * sizeof(unsigned int);
+    if (vertices) bytes += vertexCapacity * 3 * sizeof(float);
+    if (normals) bytes += vertexCapacity * 3 * sizeof(float);
+    if (texcoords) bytes += vertexCapacity * 2 * sizeof(float);
+    if (colors) bytes += vertexCapacity * 3 * sizeof(float);
+    return bytes;
+}
+
+/**
+ * Quantize a colour component to 8 bit.
+ */
+unsigned char OBJMeshData::Quantize(float c) {
+    return (unsigned char)(std::min(std::max(c, 0.0f), 1.0f) * 255.0f + 0.5f);
+}
+
+/**
+ * Create a colour data block for a subset of the vertices.
+ *
+ * @param order Vertex of each element in the block
+ * @param count Number of elements
+ * @return Colour block, or a NULL pointer if there are no colours
+ */
+IDataBlockPtr OBJMeshData::ColorBlock(const unsigned int* order, unsigned int count) const {
+    if (!colors) return IDataBlockPtr();
+    if (byteColors) {
+        unsigned char* cd = new unsigned char[count*4];
+        for (unsigned int i = 0; i < count; ++i) {
+            for (unsigned int j = 0; j < 3; ++j)
+                cd[i*4+j] = Quantize(colors[order[i]*3+j]);
+            cd[i*4+3] = 255;
+        }
+        return IDataBlockPtr(new DataBlock<4,unsigned char>(count, cd));
+    }
+    float* cd = new float[count*3];
+    for (unsigned int i = 0; i < count; ++i)
+        for (unsigned int j = 0; j < 3; ++j)
+            cd[i*3+j] = colors[order[i]*3+j];
+    return IDataBlockPtr(new DataBlock<3,float>(count, cd));
+}
+
+/**
+ * Hand the position array over to a data block.
+ */
+Float3DataBlockPtr OBJMeshData::TakeVertices() {
+    Float3DataBlockPtr block(OBJMakeDataBlock<3>(vertexCount, vertices, allocator, vertexCapacity*3));
+    vertices = NULL;
+    return block;
+}
+
+/**
+ * Hand the normal array over to a data block.
+ */
+Float3DataBlockPtr OBJMeshData::TakeNormals() {
+    Float3DataBlockPtr block(OBJMakeDataBlock<3>(vertexCount, normals, allocator, vertexCapacity*3));
+    normals = NULL;
+    return block;
+}
+
+/**
+ * Hand the texture coordinate array over to a data block.
+ */
+Float2DataBlockPtr OBJMeshData::TakeTexcoords() {
+    Float2DataBlockPtr block(OBJMakeDataBlock<2>(vertexCount, texcoords, allocator, vertexCapacity*2));
+    texcoords = NULL;
+    return block;
+}
+
+/**
+ * Hand the colour array over to a data block, quantizing it if
+ * byteColors is set.
+ *
+ * @return Colour block, or a NULL pointer if there are no colours
+ */
+IDataBlockPtr OBJMeshData::TakeColors() {
+    if (!colors) return IDataBlockPtr();
+    IDataBlockPtr block;
+    if (byteColors) {
+        unsigned char* cd = OBJAllocate<unsigned char>(allocator, vertexCount*4);
+        for (unsigned int i = 0; i < vertexCount; ++i) {
+            for (unsigned int j = 0; j < 3; ++j)
+                cd[i*4+j] = Quantize(colors[i*3+j]);
+            cd[i*4+3] = 255;
+        }
+        block = IDataBlockPtr(OBJMakeDataBlock<4>(vertexCount, cd, allocator, vertexCount*4));
+        OBJDeallocate(allocator, colors, vertexCapacity*3);
+    } else
+        block = IDataBlockPtr(OBJMakeDataBlock<3>(vertexCount, colors, allocator, vertexCapacity*3));
+    colors = NULL;
+    return block;
+}
+
+/**
+ * Renumber the vertices in the order they are first referenced by
+ * the triangle list.
+ * Vertices that no triangle references are dropped.
+ */
+void OBJMeshData::ReorderVertices() {
+    const unsigned int unused = vertexCount;
+    vector<unsigned int> remap(vertexCount, unused);
+    vector<unsigned int> order;
+    order.reserve(vertexCount);
+    for (unsigned int i = 0; i < triangleCount*3; ++i) {
+        unsigned int v = indices[i];
+        if (remap[v] == unused) {
+            remap[v] = order.size();
+            order.push_back(v);
+        }
+        indices[i] = remap[v];
+    }
+    PermuteVertices(order);
+}
+
+/**
+ * Gather the vertex attributes into a new order.
+ * Indices are not touched, so callers must remap them.
+ *
+ * @param order Old vertex index for each new vertex index
+ */
+void OBJMeshData::PermuteVertices(const vector<unsigned int>& order) {
+    const int count = order.size();
+    float* vd = OBJAllocate<float>(allocator, count*3);
+    float* nd = OBJAllocate<float>(allocator, count*3);
+    float* td = OBJAllocate<float>(allocator, count*2);
+    float* cd = colors ? OBJAllocate<float>(allocator, count*3) : NULL;
+    #pragma omp parallel for
+    for (int i = 0; i < count; ++i) {
+        unsigned int o = order[i];
+        vd[i*3]   = vertices[o*3];
+        vd[i*3+1] = vertices[o*3+1];
+        vd[i*3+2] = vertices[o*3+2];
+        nd[i*3]   = normals[o*3];
+        nd[i*3+1] = normals[o*3+1];
+        nd[i*3+2] = normals[o*3+2];
+        td[i*2]   = texcoords[o*2];
+        td[i*2+1] = texcoords[o*2+1];
+        if (cd)
+            for (unsigned int j = 0; j < 3; ++j)
+                cd[i*3+j] = colors[o*3+j];
+    }
+    FreeVertices();
+    vertices = vd;
+    normals = nd;
+    texcoords = td;
+    colors = cd;
+    vertexCapacity = vertexCount = count;
+}
+
+/**
+ * Gather the triangles and their materials into a new order.
+ *
+ * @param order Old triangle index for each new triangle index
+ */
+void OBJMeshData::PermuteTriangles(const vector<unsigned int>& order) {
+    const int count = order.size();
+    unsigned int* id = OBJAllocate<unsigned int>(allocator, count*3);
+    unsigned int* md = OBJAllocate<unsigned int>(allocator, count);
+    #pragma omp parallel for
+    for (int t = 0; t < count; ++t) {
+        unsigned int o = order[t];
+        id[t*3]   = indices[o*3];
+        id[t*3+1] = indices[o*3+1];
+        id[t*3+2] = indices[o*3+2];
+        md[t] = materials[o];
+    }
+    OBJDeallocate(allocator, indices, triangleCapacity*3);
+    OBJDeallocate(allocator, materials, triangleCapacity);
+    indices = id;
+    materials = md;
+    triangleCapacity = triangleCount = count;
+}
+
+} // NS Resources
+} // NS OpenEngine
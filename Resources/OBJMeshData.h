@@ -0,0 +1,81 @@
+// OBJ intermediate mesh data.
+// -------------------------------------------------------------------
+// Copyright (C) 2007 OpenEngine.dk (See AUTHORS)
+//
+// This program is free software; It is covered by the GNU General
+// Public License version 2 or any later version.
+// See the GNU General Public License for more details (see LICENSE).
+//--------------------------------------------------------------------
+
+#ifndef _OBJ_MESH_DATA_H_
+#define _OBJ_MESH_DATA_H_
+
+#include <Resources/IDataBlock.h>
+#include <Resources/DataBlock.h>
+#include <Resources/OBJAllocator.h>
+
+#include <vector>
+
+namespace OpenEngine {
+namespace Resources {
+
+using namespace std;
+
+/**
+ * Indexed triangle data produced by the OBJ loader.
+ *
+ * The attribute arrays are tightly packed (three floats per vertex
+ * for positions, normals and colours, two for texture coordinates)
+ * and come from the allocator given at construction, or new[] if it
+ * is NULL, so they can be handed directly to a DataBlock when the
+ * optional load passes are done with them. The colour array is only
+ * allocated for files with vertex colours.
+ *
+ * @class OBJMeshData OBJMeshData.h "OBJMeshData.h"
+ */
+class OBJMeshData {
+private:
+    unsigned int vertexCapacity;   //!< vertices the arrays were allocated for
+    unsigned int triangleCapacity; //!< triangles the arrays were allocated for
+
+    void FreeVertices();
+
+    // no copying, the arrays are owned
+    OBJMeshData(const OBJMeshData&);
+    OBJMeshData& operator=(const OBJMeshData&);
+
+public:
+    unsigned int vertexCount;   //!< number of vertices in the arrays
+    unsigned int triangleCount; //!< number of triangles in indices
+    unsigned int* indices;      //!< triangle list, three per triangle
+    unsigned int* materials;    //!< material number of each triangle
+    float* vertices;            //!< vertex positions
+    float* normals;             //!< vertex normals
+    float* texcoords;           //!< vertex texture coordinates
+    float* colors;              //!< vertex colours or NULL
+    bool byteColors;            //!< colour blocks are 8 bit RGBA
+    OBJAllocatorPtr allocator;  //!< source of the arrays or NULL
+
+    OBJMeshData(unsigned int vertexCount, unsigned int triangleCount,
+                OBJAllocatorPtr allocator = OBJAllocatorPtr());
+    ~OBJMeshData();
+
+    static unsigned char Quantize(float c);
+    unsigned int AddVertices(unsigned int count);
+    void AddColors();
+    void Swap(OBJMeshData& other);
+    IDataBlockPtr ColorBlock(const unsigned int* order, unsigned int count) const;
+    Float3DataBlockPtr TakeVertices();
+    Float3DataBlockPtr TakeNormals();
+    Float2DataBlockPtr TakeTexcoords();
+    IDataBlockPtr TakeColors();
+    void ReorderVertices();
+    void PermuteVertices(const vector<unsigned int>& order);
+    void PermuteTriangles(const vector<unsigned int>& order);
+    size_t GetSizeInBytes() const;
+};
+
+} // NS Resources
+} // NS OpenEngine
+
+#endif // _OBJ_MESH_DATA_H_
@@ -0,0 +1,139 @@
+// OBJ text parsing primitives.
+// -------------------------------------------------------------------
+// Copyright (C) 2007 OpenEngine.dk (See AUTHORS)
+//
+// This program is free software; It is covered by the GNU General
+// Public License version 2 or any later version.
+// See the GNU General Public License for more details (see LICENSE).
+//--------------------------------------------------------------------
+
+#ifndef _OBJ_PARSER_H_
+#define _OBJ_PARSER_H_
+
+#include <cmath>
+#include <cstring>
+
+namespace OpenEngine {
+namespace Resources {
+
+/**
+ * Parsing primitives for OBJ text held in memory.
+ *
+ * The functions work on a [begin;end) range of characters that does
+ * not have to be zero terminated, never consult the locale and do
+ * not allocate, so chunks of a file can be parsed by separate
+ * threads. Line splitting uses memchr, which the C library
+ * implements with vector instructions.
+ *
+ * @class OBJParser OBJParser.h "OBJParser.h"
+ */
+class OBJParser {
+public:
+    /**
+     * Get the start of the line following the one at s.
+     */
+    static const char* NextLine(const char* s, const char* end) {
+        const char* nl = (const char*)memchr(s, '\n', end - s);
+        return nl ? nl + 1 : end;
+    }
+
+    /**
+     * Get the end of the line at s, excluding the line break.
+     */
+    static const char* LineEnd(const char* s, const char* end) {
+        const char* nl = (const char*)memchr(s, '\n', end - s);
+        if (!nl) nl = end;
+        if (nl > s && nl[-1] == '\r') --nl;
+        return nl;
+    }
+
+    /**
+     * Skip spaces and tabs.
+     */
+    static const char* SkipSpaces(const char* s, const char* end) {
+        while (s < end && (*s == ' ' || *s == '\t')) ++s;
+        return s;
+    }
+
+    /**
+     * Parse a decimal number with optional sign, fraction and
+     * exponent.
+     *
+     * @param s Start of the number, moved past it on success
+     * @param end End of the text
+     * @param d Set to the parsed value
+     * @return True if a number was parsed
+     */
+    static bool ParseDouble(const char*& s, const char* end, double& d) {
+        static const double powers[] = {
+            1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+            1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+        };
+        const char* p = s;
+        bool neg = false;
+        if (p < end && (*p == '-' || *p == '+')) neg = *p++ == '-';
+        double mant = 0.0;
+        int digits = 0, exp = 0;
+        for (; p < end && (unsigned)(*p - '0') < 10; ++p, ++digits)
+            mant = mant * 10.0 + (*p - '0');
+        if (p < end && *p == '.')
+            for (++p; p < end && (unsigned)(*p - '0') < 10; ++p, ++digits, --exp)
+                mant = mant * 10.0 + (*p - '0');
+        if (digits == 0) return false;
+        if (p < end && (*p == 'e' || *p == 'E')) {
+            const char* q = p + 1;
+            bool eneg = false;
+            if (q < end && (*q == '-' || *q == '+')) eneg = *q++ == '-';
+            int e = 0, edigits = 0;
+            for (; q < end && (unsigned)(*q - '0') < 10; ++q, ++edigits)
+                e = e * 10 + (*q - '0');
+            if (edigits == 0) return false;
+            exp += eneg ? -e : e;
+            p = q;
+        }
+        if (exp < 0)
+            mant = -exp <= 22 ? mant / powers[-exp] : mant * pow(10.0, exp);
+        else if (exp > 0)
+            mant = exp <= 22 ? mant * powers[exp] : mant * pow(10.0, exp);
+        d = neg ? -mant : mant;
+        s = p;
+        return true;
+    }
+
+    /**
+     * Parse a number into a float.
+     * @see ParseDouble
+     */
+    static bool ParseFloat(const char*& s, const char* end, float& f) {
+        double d;
+        if (!ParseDouble(s, end, d)) return false;
+        f = (float)d;
+        return true;
+    }
+
+    /**
+     * Parse up to max whitespace separated numbers.
+     *
+     * @param s Start of the first number, moved past the last one
+     * @param end End of the line
+     * @param out Array the numbers are written to
+     * @param max Size of the out array
+     * @return Number of numbers parsed, or max+1 if there are more
+     *         or something that is not a number follows
+     */
+    static unsigned int ParseDoubles(const char*& s, const char* end,
+                                     double* out, unsigned int max) {
+        unsigned int n = 0;
+        for (s = SkipSpaces(s, end); s < end; s = SkipSpaces(s, end)) {
+            if (n == max || !ParseDouble(s, end, out[n])) return max + 1;
+            if (s < end && *s != ' ' && *s != '\t') return max + 1;
+            ++n;
+        }
+        return n;
+    }
+};
+
+} // NS Resources
+} // NS OpenEngine
+
+#endif // _OBJ_PARSER_H_
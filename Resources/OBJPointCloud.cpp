@@ -0,0 +1,349 @@
+// OBJ point cloud loading.
+// -------------------------------------------------------------------
+// Copyright (C) 2007 OpenEngine.dk (See AUTHORS)
+//
+// This program is free software; It is covered by the GNU General
+// Public License version 2 or any later version.
+// See the GNU General Public License for more details (see LICENSE).
+//--------------------------------------------------------------------
+
+#include <Resources/OBJPointCloud.h>
+#include <Resources/OBJParser.h>
+#include <Resources/OBJConversion.h>
+#include <Resources/OBJMeshData.h>
+#include <Resources/DataBlock.h>
+#include <Resources/File.h>
+#include <Geometry/GeometrySet.h>
+#include <Scene/SceneNode.h>
+#include <Scene/MeshNode.h>
+
+#include <algorithm>
+#include <cfloat>
+#include <limits>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace OpenEngine {
+namespace Resources {
+
+using namespace OpenEngine::Scene;
+
+const unsigned int OBJPointCloud::SLICE_SIZE;
+
+// chunks per thread, more chunks even out the work between threads
+static const int CHUNKS_PER_THREAD = 4;
+
+/**
+ * Allocate the position slices for a number of points. The colour
+ * slices are added by AddColors() if the points have colours.
+ */
+OBJPointCloud::OBJPointCloud(unsigned int count, bool quantize)
+    : count(count), colored(false), quantize(quantize) {
+    for (unsigned int first = 0; first < count; first += SLICE_SIZE)
+        vertices.push_back(new float[std::min(SLICE_SIZE, count - first)*3]);
+}
+
+/**
+ * Delete the slices that were not handed over to data blocks.
+ */
+OBJPointCloud::~OBJPointCloud() {
+    for (unsigned int s = 0; s < vertices.size(); ++s)
+        delete[] vertices[s];
+    for (unsigned int s = 0; s < colors.size(); ++s)
+        delete[] colors[s];
+    for (unsigned int s = 0; s < byteColors.size(); ++s)
+        delete[] byteColors[s];
+}
+
+/**
+ * Allocate a colour slice for each position slice.
+ */
+void OBJPointCloud::AddColors() {
+    colored = true;
+    for (unsigned int s = 0; s < vertices.size(); ++s) {
+        unsigned int n = std::min(SLICE_SIZE, count - s * SLICE_SIZE);
+        if (quantize)
+            byteColors.push_back(new unsigned char[n*4]);
+        else
+            colors.push_back(new float[n*3]);
+    }
+}
+
+/**
+ * Drop the points past the first count, and free the slices that no
+ * longer hold any.
+ */
+void OBJPointCloud::Truncate(unsigned int count) {
+    const unsigned int slices = (count + SLICE_SIZE - 1) / SLICE_SIZE;
+    for (unsigned int s = slices; s < vertices.size(); ++s)
+        delete[] vertices[s];
+    for (unsigned int s = slices; s < colors.size(); ++s)
+        delete[] colors[s];
+    for (unsigned int s = slices; s < byteColors.size(); ++s)
+        delete[] byteColors[s];
+    vertices.resize(std::min<size_t>(slices, vertices.size()));
+    colors.resize(std::min<size_t>(slices, colors.size()));
+    byteColors.resize(std::min<size_t>(slices, byteColors.size()));
+    this->count = std::min(count, this->count);
+}
+
+/**
+ * Get the position of point i.
+ */
+float* OBJPointCloud::Vertex(unsigned int i) {
+    return vertices[i / SLICE_SIZE] + (i % SLICE_SIZE) * 3;
+}
+
+/**
+ * Set the colour of point i, the cloud must have colours.
+ */
+void OBJPointCloud::SetColor(unsigned int i, float r, float g, float b) {
+    if (quantize) {
+        unsigned char* c = byteColors[i / SLICE_SIZE] + (i % SLICE_SIZE) * 4;
+        c[0] = OBJMeshData::Quantize(r);
+        c[1] = OBJMeshData::Quantize(g);
+        c[2] = OBJMeshData::Quantize(b);
+        c[3] = 255;
+    } else {
+        float* c = colors[i / SLICE_SIZE] + (i % SLICE_SIZE) * 3;
+        c[0] = r; c[1] = g; c[2] = b;
+    }
+}
+
+/**
+ * Copy point from, with its colour, over point to.
+ */
+void OBJPointCloud::Move(unsigned int from, unsigned int to) {
+    std::copy(Vertex(from), Vertex(from) + 3, Vertex(to));
+    if (!colors.empty()) {
+        const float* c = colors[from / SLICE_SIZE] + (from % SLICE_SIZE) * 3;
+        std::copy(c, c + 3, colors[to / SLICE_SIZE] + (to % SLICE_SIZE) * 3);
+    }
+    if (!byteColors.empty()) {
+        const unsigned char* c = byteColors[from / SLICE_SIZE] + (from % SLICE_SIZE) * 4;
+        std::copy(c, c + 4, byteColors[to / SLICE_SIZE] + (to % SLICE_SIZE) * 4);
+    }
+}
+
+/**
+ * Create a points mesh for each slice.
+ */
+ISceneNode* OBJPointCloud::Build(MaterialPtr mat, vector<MeshPtr>& meshes) {
+    IndicesPtr full;
+    vector<ISceneNode*> nodes;
+    for (unsigned int s = 0; s < vertices.size(); ++s) {
+        const unsigned int first = s * SLICE_SIZE;
+        unsigned int n = first < count ? std::min(SLICE_SIZE, count - first) : 0;
+        // only the last slice is short and needs its own index block
+        IndicesPtr is = n == SLICE_SIZE ? full : IndicesPtr();
+        if (!is) {
+            unsigned short* id = new unsigned short[n];
+            for (unsigned int i = 0; i < n; ++i)
+                id[i] = i;
+            is = IndicesPtr(new Indices(n, id));
+            if (n == SLICE_SIZE) full = is;
+        }
+        IDataBlockPtr cs;
+        if (!colors.empty()) {
+            cs = IDataBlockPtr(new DataBlock<3,float>(n, colors[s]));
+            colors[s] = NULL;
+        }
+        if (!byteColors.empty()) {
+            cs = IDataBlockPtr(new DataBlock<4,unsigned char>(n, byteColors[s]));
+            byteColors[s] = NULL;
+        }
+        GeometrySetPtr gs = GeometrySetPtr(new GeometrySet(Float3DataBlockPtr(new DataBlock<3,float>(n, vertices[s])),
+                                                           Float3DataBlockPtr(), IDataBlockList(), cs));
+        vertices[s] = NULL;
+        MeshPtr mesh = MeshPtr(new Mesh(is, POINTS, gs, mat));
+        meshes.push_back(mesh);
+        nodes.push_back(new MeshNode(mesh));
+    }
+    if (nodes.size() == 1) return nodes[0];
+    ISceneNode* node = new SceneNode();
+    for (unsigned int i = 0; i < nodes.size(); ++i)
+        node->AddNode(nodes[i]);
+    return node;
+}
+
+/**
+ * Load the vertex records of an OBJ file as a point cloud.
+ *
+ * Invalid vertex records are skipped and counted. All other records
+ * are ignored. When recentering, the first vertex is subtracted from
+ * all positions while they are still doubles, and the points are
+ * then moved so their bounding box is centered on the origin.
+ *
+ * @param file OBJ file path
+ * @param options Load options with the conversion and recentering
+ * @param mat Material of the point meshes
+ * @param meshes The created meshes are appended here
+ * @param origin Set to the offset subtracted from the positions
+ * @param points Set to the number of points loaded
+ * @param errors Set to the number of invalid vertex records
+ * @param bytes Set to the size of the file
+ * @return Node holding the point meshes
+ */
+ISceneNode* OBJPointCloud::Load(string file, const OBJLoadOptions& options,
+                                MaterialPtr mat, vector<MeshPtr>& meshes,
+                                Vector<3,double>& origin, unsigned int& points,
+                                unsigned int& errors, boost::uint64_t& bytes) {
+    // read the whole file
+    ifstream* in = File::Open(file);
+    in->seekg(0, ios::end);
+    vector<char> text(std::max((long)in->tellg(), 1L));
+    in->seekg(0, ios::beg);
+    in->read(&text[0], text.size());
+    const char* begin = &text[0];
+    const char* end = begin + in->gcount();
+    bytes = end - begin;
+    in->close();
+    delete in;
+
+    // split the text in chunks at line breaks
+    int chunks = 1;
+#ifdef _OPENMP
+    chunks = omp_get_max_threads() * CHUNKS_PER_THREAD;
+#endif
+    vector<const char*> starts(chunks + 1, end);
+    starts[0] = begin;
+    for (int c = 1; c < chunks; ++c) {
+        const char* p = begin + (end - begin) / chunks * c;
+        starts[c] = p == begin ? begin : OBJParser::NextLine(std::max(p - 1, starts[c-1]), end);
+    }
+
+    // count the vertex records of each chunk
+    vector<unsigned int> offsets(chunks + 1, 0);
+    #pragma omp parallel for
+    for (int c = 0; c < chunks; ++c) {
+        unsigned int n = 0;
+        for (const char* s = starts[c]; s < starts[c+1]; s = OBJParser::NextLine(s, starts[c+1]))
+            if (starts[c+1] - s > 1 && s[0] == 'v' && (s[1] == ' ' || s[1] == '\t'))
+                n++;
+        offsets[c+1] = n;
+    }
+    for (int c = 0; c < chunks; ++c)
+        offsets[c+1] += offsets[c];
+
+    // the first valid vertex is the provisional origin, and tells if
+    // the points are coloured
+    const OBJConversion conversion(options.transform, options.scale, options.swapYZ);
+    const bool recenter = options.recenter;
+    double first[6];
+    unsigned int components = 0;
+    origin = Vector<3,double>(0.0);
+    for (const char* s = begin; s < end; s = OBJParser::NextLine(s, end)) {
+        if (!(end - s > 1 && s[0] == 'v' && (s[1] == ' ' || s[1] == '\t')))
+            continue;
+        const char* p = s + 2;
+        components = OBJParser::ParseDoubles(p, OBJParser::LineEnd(s, end), first, 6);
+        if (components == 3 || components == 4 || components == 6) {
+            conversion.Position(first);
+            if (recenter) origin = Vector<3,double>(first[0], first[1], first[2]);
+            break;
+        }
+    }
+
+    // parse the records straight into their final slots, colour
+    // slices are only allocated when the first vertex has a colour,
+    // or parsed again in the rare case a later vertex has one
+    OBJPointCloud cloud(offsets[chunks], options.quantizeColors);
+    if (components == 6) cloud.AddColors();
+    vector<unsigned int> invalid(chunks, 0);
+    vector<char> missed(chunks, 0);
+    for (bool parse = true; parse; ) {
+        #pragma omp parallel for
+        for (int c = 0; c < chunks; ++c) {
+            unsigned int i = offsets[c];
+            invalid[c] = 0;
+            for (const char* s = starts[c]; s < starts[c+1]; s = OBJParser::NextLine(s, starts[c+1])) {
+                if (!(starts[c+1] - s > 1 && s[0] == 'v' && (s[1] == ' ' || s[1] == '\t')))
+                    continue;
+                double val[6];
+                const char* p = s + 2;
+                unsigned int n = OBJParser::ParseDoubles(p, OBJParser::LineEnd(s, starts[c+1]), val, 6);
+                float* v = cloud.Vertex(i);
+                if (n == 3 || n == 4 || n == 6) {
+                    conversion.Position(val);
+                    for (unsigned int j = 0; j < 3; ++j)
+                        v[j] = val[j] - origin[j];
+                    if (!cloud.colored)
+                        missed[c] = missed[c] || n == 6;
+                    else if (n == 6)
+                        cloud.SetColor(i, val[3], val[4], val[5]);
+                    else
+                        cloud.SetColor(i, 1.0f, 1.0f, 1.0f);
+                } else {
+                    // marked and compacted away below
+                    v[0] = std::numeric_limits<float>::quiet_NaN();
+                    invalid[c]++;
+                }
+                i++;
+            }
+        }
+        parse = !cloud.colored && std::find(missed.begin(), missed.end(), 1) != missed.end();
+        if (parse) cloud.AddColors();
+    }
+
+    errors = 0;
+    for (int c = 0; c < chunks; ++c)
+        errors += invalid[c];
+    if (errors > 0) {
+        unsigned int kept = 0;
+        for (unsigned int i = 0; i < cloud.count; ++i) {
+            if (cloud.Vertex(i)[0] != cloud.Vertex(i)[0]) continue;
+            cloud.Move(i, kept);
+            kept++;
+        }
+        cloud.Truncate(kept);
+    }
+
+    // move the bounding box center to the origin
+    if (recenter && cloud.count > 0) {
+        Vector<3,float> min(FLT_MAX), max(-FLT_MAX);
+        for (unsigned int i = 0; i < cloud.count; ++i)
+            for (unsigned int j = 0; j < 3; ++j) {
+                min[j] = std::min(min[j], cloud.Vertex(i)[j]);
+                max[j] = std::max(max[j], cloud.Vertex(i)[j]);
+            }
+        Vector<3,float> center = (min + max) * 0.5f;
+        const int count = cloud.count;
+        #pragma omp parallel for
+        for (int i = 0; i < count; ++i)
+            for (unsigned int j = 0; j < 3; ++j)
+                cloud.Vertex(i)[j] -= center[j];
+        for (unsigned int j = 0; j < 3; ++j)
+            origin[j] += center[j];
+    }
+    points = cloud.count;
+    return cloud.Build(mat, meshes);
+}
+
+/**
+ * Create point meshes from arrays of points. The points are copied
+ * straight into the slices of the meshes.
+ *
+ * @param vertices Positions
+ * @param colors Colours, or NULL
+ * @param count Number of points
+ * @param quantize Store the colours as 8 bit RGBA
+ * @param mat Material of the point meshes
+ * @param meshes The created meshes are appended here
+ * @return Node holding the point meshes
+ */
+ISceneNode* OBJPointCloud::Build(const Vector<3,float>* vertices, const Vector<3,float>* colors,
+                                 unsigned int count, bool quantize, MaterialPtr mat,
+                                 vector<MeshPtr>& meshes) {
+    OBJPointCloud cloud(count, quantize);
+    if (colors) cloud.AddColors();
+    for (unsigned int i = 0; i < count; ++i) {
+        vertices[i].ToArray(cloud.Vertex(i));
+        if (colors) cloud.SetColor(i, colors[i][0], colors[i][1], colors[i][2]);
+    }
+    return cloud.Build(mat, meshes);
+}
+
+} // NS Resources
+} // NS OpenEngine
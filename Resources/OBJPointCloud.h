@@ -0,0 +1,82 @@
+// OBJ point cloud loading.
+// -------------------------------------------------------------------
+// Copyright (C) 2007 OpenEngine.dk (See AUTHORS)
+//
+// This program is free software; It is covered by the GNU General
+// Public License version 2 or any later version.
+// See the GNU General Public License for more details (see LICENSE).
+//--------------------------------------------------------------------
+
+#ifndef _OBJ_POINT_CLOUD_H_
+#define _OBJ_POINT_CLOUD_H_
+
+#include <Resources/OBJResource.h>
+#include <Geometry/Mesh.h>
+#include <Math/Vector.h>
+#include <Scene/ISceneNode.h>
+
+#include <string>
+#include <vector>
+
+namespace OpenEngine {
+namespace Resources {
+
+using namespace OpenEngine::Geometry;
+using OpenEngine::Scene::ISceneNode;
+using OpenEngine::Math::Vector;
+using namespace std;
+
+/**
+ * Loading of OBJ files as point clouds.
+ *
+ * Only vertex records are read, including the common six component
+ * "v x y z r g b" colour extension, and every vertex becomes a
+ * point. The file is read into memory in one go and split into
+ * chunks at line breaks, which are first counted and then parsed in
+ * parallel straight into the final vertex and colour arrays.
+ *
+ * Positions are parsed as doubles, converted and recentered as
+ * given by the load options and then stored as floats. Colours are
+ * only stored for files that have them, as 8 bit RGBA when the
+ * options quantize colours.
+ *
+ * The points are split into meshes of at most 65536 points so they
+ * can be drawn with 16 bit indices. All full meshes share the same
+ * index block.
+ *
+ * @class OBJPointCloud OBJPointCloud.h "OBJPointCloud.h"
+ */
+class OBJPointCloud {
+private:
+    unsigned int count;       //!< number of points
+    bool colored;             //!< some point has a colour
+    bool quantize;            //!< colours are stored as 8 bit RGBA
+    vector<float*> vertices;  //!< vertex array of each slice
+    vector<float*> colors;    //!< colour array of each slice, if colored
+    vector<unsigned char*> byteColors; //!< 8 bit colour array of each slice, if colored
+
+    OBJPointCloud(unsigned int count, bool quantize);
+    ~OBJPointCloud();
+    void AddColors();
+    void Truncate(unsigned int count);
+    float* Vertex(unsigned int i);
+    void SetColor(unsigned int i, float r, float g, float b);
+    void Move(unsigned int from, unsigned int to);
+    ISceneNode* Build(MaterialPtr mat, vector<MeshPtr>& meshes);
+
+public:
+    static const unsigned int SLICE_SIZE = 0x10000; //!< points per mesh
+
+    static ISceneNode* Load(string file, const OBJLoadOptions& options,
+                            MaterialPtr mat, vector<MeshPtr>& meshes,
+                            Vector<3,double>& origin, unsigned int& points,
+                            unsigned int& errors, boost::uint64_t& bytes);
+    static ISceneNode* Build(const Vector<3,float>* vertices, const Vector<3,float>* colors,
+                             unsigned int count, bool quantize, MaterialPtr mat,
+                             vector<MeshPtr>& meshes);
+};
+
+} // NS Resources
+} // NS OpenEngine
+
+#endif // _OBJ_POINT_CLOUD_H_
@@ -9,6 +9,18 @@
 //--------------------------------------------------------------------
 
 #include <Resources/OBJResource.h>
+#include <Resources/OBJMeshData.h>
+#include <Resources/OBJSpatialSort.h>
+#include <Resources/OBJWeld.h>
+#include <Resources/OBJChunker.h>
+#include <Resources/OBJInstancer.h>
+#include <Resources/OBJTextureAtlas.h>
+#include <Resources/OBJPointCloud.h>
+#include <Resources/OBJConversion.h>
+#include <Resources/OBJStripifier.h>
+#include <Resources/OBJTrace.h>
+#include <Resources/OBJThreadLocal.h>
+#include <Resources/OBJFaceKey.h>
 #include <Resources/DirectoryManager.h>
 #include <Resources/ResourceManager.h>
 #include <Resources/File.h>
@@ -16,23 +28,299 @@
 #include <Utils/Convert.h>
 
 #include <Scene/MeshNode.h>
+#include <Scene/SceneNode.h>
+#include <Scene/TransformationNode.h>
 #include <Geometry/GeometrySet.h>
 #include <Resources/DataBlock.h>
 
+#include <boost/unordered_set.hpp>
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <sstream>
 
 namespace OpenEngine {
 namespace Resources {
 
 using namespace OpenEngine::Logging;
 using OpenEngine::Utils::Convert;
+using OpenEngine::Utils::Time;
+using OpenEngine::Utils::Timer;
 using namespace OpenEngine::Scene;
 
+// parse data kept in the per load arena
+typedef vector<unsigned int, OBJStlAllocator<unsigned int> > ArenaIndices;
+typedef vector<Vector<3,float>, OBJStlAllocator<Vector<3,float> > > ArenaVectors3;
+typedef vector<Vector<2,float>, OBJStlAllocator<Vector<2,float> > > ArenaVectors2;
+
+/**
+ * The parse data of a load.
+ * Each thread keeps one set of buffers that is cleared between
+ * loads, so small loads do not allocate them again. Buffers larger
+ * than RETAINED_BUFFER_SIZE are freed as soon as they are consumed.
+ */
+struct ParseBuffers {
+    ArenaIndices indices, faceMaterial, objects;
+    ArenaIndices lineIndices, pointIndices, elementVerts, element, remap;
+    ArenaVectors3 vert, norm, vcol;
+    ArenaVectors2 texc;
+    boost::unordered_set<OBJFaceKey> faces;
+    bool inUse; //!< a load on the thread is using the buffers
+
+    ParseBuffers(OBJStlAllocator<unsigned int> temp)
+        : indices(temp), faceMaterial(temp), objects(temp)
+        , lineIndices(temp), pointIndices(temp), elementVerts(temp)
+        , element(temp), remap(temp)
+        , vert(temp), norm(temp), vcol(temp), texc(temp)
+        , inUse(false) {}
+
+    void Clear() {
+        indices.clear(); faceMaterial.clear(); objects.clear();
+        lineIndices.clear(); pointIndices.clear(); elementVerts.clear();
+        element.clear(); remap.clear();
+        vert.clear(); norm.clear(); vcol.clear(); texc.clear();
+        faces.clear();
+    }
+
+    size_t GetSizeInBytes() const {
+        return (indices.capacity() + faceMaterial.capacity() + objects.capacity() +
+                lineIndices.capacity() + pointIndices.capacity() + elementVerts.capacity() +
+                element.capacity() + remap.capacity()) * sizeof(unsigned int) +
+            (vert.capacity() + norm.capacity() + vcol.capacity()) * sizeof(Vector<3,float>) +
+            texc.capacity() * sizeof(Vector<2,float>) +
+            faces.size() * sizeof(OBJFaceKey) + faces.bucket_count() * sizeof(void*);
+    }
+};
+
+// largest parse buffer kept for the next load once consumed
+static const unsigned int RETAINED_BUFFER_SIZE = 1 << 20;
+
+/**
+ * Free the storage of a consumed parse buffer if it is large, so big
+ * models do not hold the parse data and the mesh data at once.
+ * Small buffers are only cleared and kept for the next load.
+ */
+template <class T, class A>
+static void Release(vector<T,A>& v) {
+    if (v.capacity() * sizeof(T) > RETAINED_BUFFER_SIZE)
+        vector<T,A>(v.get_allocator()).swap(v);
+    else
+        v.clear();
+}
+
+/**
+ * Marks the buffers of a thread as used for the lifetime of a load.
+ */
+struct ParseBuffersLock {
+    ParseBuffers* buffers;
+    ParseBuffersLock(ParseBuffers* buffers) : buffers(buffers) {
+        if (buffers) buffers->inUse = true;
+    }
+    ~ParseBuffersLock() {
+        if (buffers) buffers->inUse = false;
+    }
+};
+
+// buffers of the calling thread, created by the first load on it
+static OBJ_THREAD_LOCAL ParseBuffers* threadBuffers = NULL;
+
+// memory of all loaded resources, only changed by the atomic helpers
+static volatile boost::int64_t totalVertexBytes = 0;
+static volatile boost::int64_t totalIndexBytes = 0;
+static volatile boost::int64_t totalMaterialBytes = 0;
+static volatile boost::int64_t totalAuxiliaryBytes = 0;
+static volatile boost::int64_t totalPeakTemporaryBytes = 0;
+static volatile boost::int64_t totalResources = 0;
+
+/**
+ * Add to a counter shared by all threads.
+ *
+ * @return The new value
+ */
+static boost::int64_t AtomicAdd(volatile boost::int64_t& counter, boost::int64_t delta) {
+#ifdef _MSC_VER
+    return _InterlockedExchangeAdd64((volatile __int64*)&counter, delta) + delta;
+#else
+    return __sync_add_and_fetch(&counter, delta);
+#endif
+}
+
+/**
+ * Raise a counter shared by all threads to at least a value.
+ */
+static void AtomicMax(volatile boost::int64_t& counter, boost::int64_t value) {
+    boost::int64_t old = AtomicAdd(counter, 0);
+    while (old < value) {
+#ifdef _MSC_VER
+        boost::int64_t seen = _InterlockedCompareExchange64((volatile __int64*)&counter, value, old);
+#else
+        boost::int64_t seen = __sync_val_compare_and_swap(&counter, old, value);
+#endif
+        if (seen == old) break;
+        old = seen;
+    }
+}
+
+/**
+ * Add the memory of a resource to the totals, or subtract it.
+ */
+static void AddToTotals(const OBJMemoryUsage& usage, int sign) {
+    AtomicAdd(totalVertexBytes, sign * (boost::int64_t)usage.vertexBytes);
+    AtomicAdd(totalIndexBytes, sign * (boost::int64_t)usage.indexBytes);
+    AtomicAdd(totalMaterialBytes, sign * (boost::int64_t)usage.materialBytes);
+    AtomicAdd(totalAuxiliaryBytes, sign * (boost::int64_t)usage.auxiliaryBytes);
+    AtomicAdd(totalResources, sign * (boost::int64_t)usage.resources);
+}
+
+/**
+ * Get the bytes of a data block not counted yet.
+ */
+static boost::uint64_t BlockBytes(IDataBlockPtr block, boost::unordered_set<const void*>& seen) {
+    if (!block || !seen.insert(block.get()).second) return 0;
+    return block->GetSizeInBytes();
+}
+
+/**
+ * Get the bytes of a material and its loaded textures not counted
+ * yet. Textures are assumed to have 8 bit channels.
+ */
+static boost::uint64_t MaterialBytes(MaterialPtr mat, boost::unordered_set<const void*>& seen) {
+    if (!mat || !seen.insert(mat.get()).second) return 0;
+    boost::uint64_t bytes = sizeof(Material);
+    list< pair<string, ITexture2DPtr> > textures = mat->Get2DTextures();
+    for (list< pair<string, ITexture2DPtr> >::iterator i = textures.begin(); i != textures.end(); ++i) {
+        ITexture2DPtr tex = i->second;
+        if (tex && tex->GetVoidDataPtr() && seen.insert(tex.get()).second)
+            bytes += (boost::uint64_t)tex->GetWidth() * tex->GetHeight() * tex->GetChannels();
+    }
+    return bytes;
+}
+
+/**
+ * Parse the vertex indices of a line or point element.
+ * Texture coordinate indices are skipped.
+ *
+ * @param s Text following the element keyword
+ * @param vertices Number of vertices declared so far
+ * @param out Zero based vertex indices are appended here
+ * @return True if all indices are valid
+ */
+static bool ParseElement(const char* s, unsigned int vertices, ArenaIndices& out) {
+    for (;;) {
+        while (*s == ' ' || *s == '\t') ++s;
+        if (*s == '\0' || *s == '\r') return true;
+        char* end;
+        long v = strtol(s, &end, 10);
+        if (end == s || v < 1 || (unsigned long)v > vertices) return false;
+        out.push_back(v - 1);
+        for (s = end; *s == '/' || isdigit(*s); ++s);
+        if (*s != ' ' && *s != '\t' && *s != '\0' && *s != '\r') return false;
+    }
+}
+
+/**
+ * Check that the position, texture coordinate and normal numbers of
+ * a face refer to ones read before it. Texture coordinates and
+ * normals that are left out read as zero.
+ */
+static bool ValidFace(const Vector<9,int>& f, unsigned int vertices,
+                      unsigned int texcoords, unsigned int normals) {
+    for (unsigned int k = 0; k < 3; ++k)
+        if (f[k*3] < 1 || (unsigned int)f[k*3] > vertices ||
+            f[k*3+1] < 0 || (unsigned int)f[k*3+1] > texcoords ||
+            f[k*3+2] < 0 || (unsigned int)f[k*3+2] > normals)
+            return false;
+    return true;
+}
+
+/**
+ * Create a mesh drawing line or point elements from a vertex set.
+ */
+static MeshPtr ElementMesh(const ArenaIndices& elements, unsigned int base,
+                           GeometryPrimitive type, GeometrySetPtr gs, MaterialPtr mat) {
+    unsigned short* id = new unsigned short[elements.size()];
+    for (unsigned int i = 0; i < elements.size(); ++i)
+        id[i] = base + elements[i];
+    return MeshPtr(new Mesh(IndicesPtr(new Indices(elements.size(), id)), type, gs, mat));
+}
+
+/**
+ * Create a vertex set for line or point elements from vertices of
+ * the file, with zero normals and texture coordinates.
+ *
+ * @param verts File vertex of each vertex in the set
+ * @param count Number of vertices in the set
+ */
+static GeometrySetPtr ElementGeometry(const unsigned int* verts, unsigned int count,
+                                      const ArenaVectors3& vert, const ArenaVectors3& vcol,
+                                      const OBJLoadOptions& options) {
+    OBJMeshData data(0, 0, options.allocator);
+    if (!vcol.empty()) {
+        data.AddColors();
+        data.byteColors = options.quantizeColors;
+    }
+    data.AddVertices(count);
+    for (unsigned int i = 0; i < count; ++i) {
+        vert[verts[i]].ToArray(&data.vertices[i*3]);
+        if (data.colors)
+            vcol[verts[i]].ToArray(&data.colors[i*3]);
+    }
+    IDataBlockList texlist;
+    texlist.push_back(data.TakeTexcoords());
+    return GeometrySetPtr(new GeometrySet(data.TakeVertices(), data.TakeNormals(),
+                                          texlist, data.TakeColors()));
+}
+
+/**
+ * Create meshes drawing line or point elements with vertex sets of
+ * their own, split so the vertices of each fit 16 bit indices.
+ *
+ * @param elements Element vertex numbers, see elementVerts
+ * @param group Indices per element, two for line segments and one for points
+ * @param elementVerts File vertex of each element vertex
+ * @param meshes Gets the meshes
+ */
+static void SplitElements(const ArenaIndices& elements, unsigned int group,
+                          GeometryPrimitive type, const ArenaIndices& elementVerts,
+                          const ArenaVectors3& vert, const ArenaVectors3& vcol,
+                          const OBJLoadOptions& options, MaterialPtr mat,
+                          vector<MeshPtr>& meshes) {
+    vector<unsigned int> remap(elementVerts.size(), ~0u), used, ids;
+    for (unsigned int i = 0; i <= elements.size(); i += group) {
+        // close the piece when the next element might not fit
+        if (i == elements.size() || used.size() + group > 0xFFFF) {
+            if (!ids.empty()) {
+                unsigned short* id = new unsigned short[ids.size()];
+                std::copy(ids.begin(), ids.end(), id);
+                GeometrySetPtr gs = ElementGeometry(&used[0], used.size(), vert, vcol, options);
+                meshes.push_back(MeshPtr(new Mesh(IndicesPtr(new Indices(ids.size(), id)),
+                                                  type, gs, mat)));
+            }
+            for (unsigned int j = 0; j < ids.size(); ++j)
+                remap[elements[i - ids.size() + j]] = ~0u;
+            used.clear();
+            ids.clear();
+            if (i == elements.size()) break;
+        }
+        for (unsigned int k = 0; k < group; ++k) {
+            const unsigned int v = elements[i + k];
+            if (remap[v] == ~0u) {
+                remap[v] = used.size();
+                used.push_back(elementVerts[v]);
+            }
+            ids.push_back(remap[v]);
+        }
+    }
+}
+
 // PLUG-IN METHODS
 
 /**
  * Get the file extension for OBJ files.
+ *
+ * @param options Load options given to all created resources
  */
-OBJPlugin::OBJPlugin() {
+OBJPlugin::OBJPlugin(OBJLoadOptions options) : options(options) {
     this->AddExtension("obj");
 }
 
@@ -40,7 +328,38 @@ OBJPlugin::OBJPlugin() {
  * Create a OBJ resource.
  */
 IModelResourcePtr OBJPlugin::CreateResource(string file) {
-    return IModelResourcePtr(new OBJResource(file));
+    return IModelResourcePtr(new OBJResource(file, options));
+}
+
+/**
+ * Set the load options given to resources created from now on.
+ */
+void OBJPlugin::SetLoadOptions(OBJLoadOptions options) {
+    this->options = options;
+}
+
+/**
+ * Get the load options given to created resources.
+ */
+OBJLoadOptions OBJPlugin::GetLoadOptions() {
+    return options;
+}
+
+/**
+ * Get the memory held by all loaded OBJ resources.
+ * The peak temporary usage is the largest of any load so far. The
+ * counters are updated atomically, so this can be called from any
+ * thread while resources are loaded.
+ */
+OBJMemoryUsage OBJPlugin::GetMemoryUsage() {
+    OBJMemoryUsage usage;
+    usage.vertexBytes = AtomicAdd(totalVertexBytes, 0);
+    usage.indexBytes = AtomicAdd(totalIndexBytes, 0);
+    usage.materialBytes = AtomicAdd(totalMaterialBytes, 0);
+    usage.auxiliaryBytes = AtomicAdd(totalAuxiliaryBytes, 0);
+    usage.peakTemporaryBytes = AtomicAdd(totalPeakTemporaryBytes, 0);
+    usage.resources = AtomicAdd(totalResources, 0);
+    return usage;
 }
 
 
@@ -49,20 +368,69 @@ IModelResourcePtr OBJPlugin::CreateResource(string file) {
 /**
  * Resource constructor.
  */
-OBJResource::OBJResource(string file) : file(file), mesh(MeshPtr()), node(NULL) {}
+OBJResource::OBJResource(string file, OBJLoadOptions options)
+    : file(file), options(options), mesh(MeshPtr()), node(NULL), origin(0.0)
+    , query(false), pending(NULL) {}
 
 /**
  * Resource destructor.
  */
 OBJResource::~OBJResource() {
     Unload();
+    // take whatever is still counted out of the totals
+    AddToTotals(memory, -1);
 }
 
 /**
- * Helper function to print out errors in the OBJ files.
+ * Helper function to count errors in the OBJ files.
+ * Errors are logged once per kind by ReportErrors() when the load
+ * is done, so files with many bad lines do not flood the log.
  */
 void OBJResource::Error(int line, string msg) {
-    logger.warning << file << " line[" << line << "] " << msg << "." << logger.end;
+    // most files have few kinds of errors, the last one is the likely match
+    vector<OBJLoadError>::reverse_iterator e = errors.rbegin();
+    while (e != errors.rend() && (e->message != msg || e->file != file))
+        ++e;
+    if (e == errors.rend()) {
+        errors.push_back(OBJLoadError(file, msg));
+        e = errors.rbegin();
+    }
+    e->count++;
+    if (e->lines.size() < options.errorLines)
+        e->lines.push_back(line);
+}
+
+/**
+ * Log each kind of error of the last load with the lines it was
+ * found on.
+ */
+void OBJResource::ReportErrors() {
+    for (unsigned int i = 0; i < errors.size(); ++i) {
+        const OBJLoadError& e = errors[i];
+        std::ostringstream msg;
+        msg << e.file;
+        if (!e.lines.empty()) {
+            msg << " line[" << e.lines[0];
+            for (unsigned int j = 1; j < e.lines.size(); ++j)
+                msg << "," << e.lines[j];
+            msg << (e.count > e.lines.size() ? ",...] " : "] ");
+        } else
+            msg << " ";
+        msg << e.message;
+        if (e.count > 1)
+            msg << " (" << e.count << " lines)";
+        logger.warning << msg.str() << "." << logger.end;
+    }
+}
+
+/**
+ * Place a node at the offset subtracted from the positions.
+ */
+static ISceneNode* Offset(ISceneNode* node, Vector<3,double> origin) {
+    TransformationNode* trans = new TransformationNode();
+    trans->SetPosition(Vector<3,float>(origin[0], origin[1], origin[2]));
+    trans->AddNode(node);
+    return trans;
 }
 
 /**
@@ -81,11 +449,15 @@ void OBJResource::Error(int line, string msg) {
  */
 void OBJResource::LoadMaterialFile(string file) {
     // open the material file
+    OBJTraceSpan trace("LoadMaterialFile", file);
     ifstream* in = File::Open(file);
+    const boost::uint64_t materialsBefore = profile.materials;
+    profile.materialFiles++;
 
     // set up working variables
     MaterialPtr m;
-    char buf[255], tmp[255];
+    string text;
+    char tmp[255];
     int line = 0;
     float tmpcol[3];
     
@@ -96,18 +468,20 @@ void OBJResource::LoadMaterialFile(string file) {
     this->file = file;
 
     // for each line in the material file...
-    while (!in->eof()) {
+    while (std::getline(*in, text)) {
         line++;
-        in->getline(buf,255);
+        const char* buf = text.c_str();
+        profile.bytesRead += text.size() + 1;
 
         // new material section
-        if (string(buf,6) == "newmtl")
-            if (sscanf(buf, "newmtl %s", tmp) != 1)
+        if (text.substr(0,6) == "newmtl")
+            if (sscanf(buf, "newmtl %254s", tmp) != 1)
                 Error(line, "Invalid newmtr declaration");
             else {
                // make a new material and add it to the material map
                 m = MaterialPtr(new Material());
                 materials.insert(make_pair(string(tmp), m));
+                profile.materials++;
                 // default material values as given in mtl specification
                 //https://people.scs.fsu.edu/~burkardt/data/mtl/mtl.html
                 m->ambient = Vector<4,float>(.2,.2,.2,1.0);
@@ -118,7 +492,7 @@ void OBJResource::LoadMaterialFile(string file) {
             }
 
         // ambient component
-        else if (string(buf,2) == "Ka")
+        else if (text.substr(0,2) == "Ka")
             if (sscanf(buf, "Ka %f %f %f", &tmpcol[0], &tmpcol[1], &tmpcol[2]) != 3)
                 Error(line, "Invalid Ka declaration");
             else if (m == NULL)
@@ -130,7 +504,7 @@ void OBJResource::LoadMaterialFile(string file) {
             }
 
         // diffuse component
-        else if (string(buf,2) == "Kd")
+        else if (text.substr(0,2) == "Kd")
             if (sscanf(buf, "Kd %f %f %f", &tmpcol[0], &tmpcol[1], &tmpcol[2]) != 3)
                 Error(line, "Invalid Kd declaration");
             else if (m == NULL)
@@ -142,7 +516,7 @@ void OBJResource::LoadMaterialFile(string file) {
             }
 
         // specular component
-        else if (string(buf,2) == "Ks")
+        else if (text.substr(0,2) == "Ks")
             if (sscanf(buf, "Ks %f %f %f", &tmpcol[0], &tmpcol[1], &tmpcol[2]) != 3)
                 Error(line, "Invalid Ks declaration");
             else if (m == NULL)
@@ -154,7 +528,7 @@ void OBJResource::LoadMaterialFile(string file) {
             }
 
         // shininess
-        else if (string(buf,2) == "Ns")
+        else if (text.substr(0,2) == "Ns")
             if (sscanf(buf, "Ns %f", tmpcol) != 1)
                 Error(line, "Invalid Ns declaration");
             else if (m == NULL)
@@ -165,8 +539,8 @@ void OBJResource::LoadMaterialFile(string file) {
 
 
         // texture material in diffuse channel
-        else if (string(buf,6) == "map_Kd")
-            if (sscanf(buf, "map_Kd %s", tmp) != 1)
+        else if (text.substr(0,6) == "map_Kd")
+            if (sscanf(buf, "map_Kd %254s", tmp) != 1)
                 Error(line, "Invalid map_Kd declaration");
             else if (m == NULL || m->Get2DTextures().size() != 0)
                 // texture != NULL means we already set it and no newmtl has appeared since
@@ -176,12 +550,17 @@ void OBJResource::LoadMaterialFile(string file) {
 				if (! DirectoryManager::IsInPath(resource_dir)) {
 					DirectoryManager::AppendPath(resource_dir);
 				}
+                Lap(profile.materialTime);
+                OBJTraceSpan texture("Texture", tmp);
                 m->AddTexture(ResourceManager<ITexture2D>::Create(string(tmp)), "diffuseMap");
+                texture.End();
+                Lap(profile.textureTime);
+                profile.textures++;
             }
 
         // shader material
-        else if (string(buf,6) == "shader") {
-            if (sscanf(buf, "shader %s", tmp) != 1)
+        else if (text.substr(0,6) == "shader") {
+            if (sscanf(buf, "shader %254s", tmp) != 1)
                 Error(line, "Invalid shader declaration");
             else if (m == NULL || m->shad != NULL)
                 // shader != NULL means we already set it and no newmtl has appeared since
@@ -191,13 +570,22 @@ void OBJResource::LoadMaterialFile(string file) {
 				if (! DirectoryManager::IsInPath(resource_dir)) {
 					DirectoryManager::AppendPath(resource_dir);
 				}
+                Lap(profile.materialTime);
+                OBJTraceSpan shader("Shader", tmp);
 				m->shad = ResourceManager<IShaderResource>::Create(string(tmp));
+                shader.End();
+                Lap(profile.textureTime);
+                profile.textures++;
             }
         }
         // we ignore all other sections in the material file
     }
     // reset file name to obj file
     this->file = objfile;
+    in->close();
+    delete in;
+    trace.Count("materials", profile.materials - materialsBefore);
+    Lap(profile.materialTime);
 }
 
 
@@ -218,47 +606,121 @@ void OBJResource::Load() {
 
     // check if we have loaded the resource
     if (node) return;
+    OBJTraceSpan trace("Load", file);
+    stats = OBJLoadStatistics();
+    memory.peakTemporaryBytes = 0;
+    profile = OBJLoadProfile();
+    errors.clear();
+    if (options.profile || options.logProfile)
+        lapStart = Timer::GetTime();
+    const Time start = lapStart;
+
+    // skip everything but the vertices of point clouds
+    if (options.pointCloud && !query) {
+        OBJTraceSpan cloudTrace("PointCloud");
+        unsigned int invalid;
+        node = OBJPointCloud::Load(file, options, MaterialPtr(), cloud,
+                                   origin, stats.cloudPoints, invalid, profile.bytesRead);
+        if (invalid > 0) {
+            errors.push_back(OBJLoadError(file, "Skipped invalid vertex"));
+            errors.back().count = invalid;
+        }
+        if (options.recenter) node = Offset(node, origin);
+        profile.vertices = stats.cloudPoints + invalid;
+        cloudTrace.End();
+        Lap(profile.geometryTime);
+        LoadDone(start, trace);
+        setlocale(LC_NUMERIC, lc->decimal_point);
+        return;
+    }
 
+    OBJTraceSpan parseTrace("Parse");
     ifstream* in = File::Open(file);
+    Lap(profile.openTime);
 
+    // the parse data is freed in one go when the arena goes out of
+    // scope, otherwise the buffers of the thread are reused unless a
+    // load further up the stack holds them
+    OBJArena arena(options.arenaBlockSize);
+    OBJStlAllocator<unsigned int> temp(options.arenaBlockSize > 0 ? &arena : NULL);
+    ParseBuffers local(temp);
+    if (options.arenaBlockSize == 0 && !threadBuffers)
+        threadBuffers = new ParseBuffers(temp);
+    const bool reuse = options.arenaBlockSize == 0 && !threadBuffers->inUse;
+    ParseBuffers& buffers = reuse ? *threadBuffers : local;
+    ParseBuffersLock lock(reuse ? threadBuffers : NULL);
+    buffers.Clear();
 
     // working variables
-    char buffer[255];
-    float f1, f2, f3;
+    string text;
+    double d1, d2, d3;
+    float f1, f2, f3, c1, c2, c3;
     int line = 0;
     //ITexture2DPtr texr;
     //IShaderResourcePtr  shad;
     MaterialPtr mat;
     MaterialPtr defaultMaterial = MaterialPtr(new Material());
-    vector<unsigned int> indices;
-    vector< Vector<3,float> > vert, norm;
-    vector< Vector<2,float> > texc;
-    Indices* is;
-    DataBlock<3,float> *vs = NULL, *ns = NULL;
-    DataBlock<2,float> *ts = NULL;
+    ArenaIndices& indices = buffers.indices;
+    vector<MaterialPtr> faceMaterials(1, MaterialPtr());
+    ArenaIndices& faceMaterial = buffers.faceMaterial;
+    unsigned int matIndex = 0;
+    ArenaIndices& objects = buffers.objects;
+    ISceneNode* instances = NULL;
+    ArenaIndices& lineIndices = buffers.lineIndices;
+    ArenaIndices& pointIndices = buffers.pointIndices;
+    ArenaIndices& elementVerts = buffers.elementVerts;
+    unsigned int elementBase = 0;
+    ArenaVectors3& vert = buffers.vert;
+    ArenaVectors3& norm = buffers.norm;
+    ArenaVectors3& vcol = buffers.vcol;
+    ArenaVectors2& texc = buffers.texc;
+    OBJConversion conversion(options.transform, options.scale, options.swapYZ);
+    Indices* is = NULL;
+    Float3DataBlockPtr vs, ns;
+    Float2DataBlockPtr ts;
+    IDataBlockPtr cs;
+    GeometryPrimitive primitive = TRIANGLES;
 
     // for each line...
-    while (!in->eof()) {
-        in->getline(buffer, 255);
+    // lines are read whole, as line and point elements can be long
+    while (std::getline(*in, text)) {
+        const char* buffer = text.c_str();
+        profile.bytesRead += text.size() + 1;
         line++;
 
         // ignored stuff
-        if (in->gcount() <= 2 || // short line
+        if (text.size() <= 1 || // short line
             buffer[0] == ' ' || // empty lines
             buffer[0] == '#' || // comments
-            buffer[0] == 'g' || // groups
             buffer[0] == 's' ) continue;
 
-        // read vertex
-        else if (string(buffer,2) == "v ") {
-            if (sscanf(buffer, "v %f %f %f", &f1, &f2, &f3) == 3)
-                vert.push_back(Vector<3,float>(f1,f2,f3));
+        // objects and groups, remember the first face of each
+        else if (buffer[0] == 'g' || text.substr(0,2) == "o ")
+            objects.push_back(faceMaterial.size());
+
+        // read vertex, colours are only stored once the first one is seen
+        else if (text.substr(0,2) == "v ") {
+            int n = sscanf(buffer, "v %lf %lf %lf %f %f %f", &d1, &d2, &d3, &c1, &c2, &c3);
+            if (n >= 3) {
+                if (n == 6)
+                    vcol.resize(vert.size(), Vector<3,float>(1.0f));
+                double p[3] = { d1, d2, d3 };
+                conversion.Position(p);
+                // the first vertex is the provisional origin when recentering
+                if (options.recenter && vert.empty())
+                    origin = Vector<3,double>(p[0], p[1], p[2]);
+                vert.push_back(Vector<3,float>(p[0] - origin[0], p[1] - origin[1], p[2] - origin[2]));
+                if (n == 6)
+                    vcol.push_back(Vector<3,float>(c1,c2,c3));
+                else if (!vcol.empty())
+                    vcol.push_back(Vector<3,float>(1.0f));
+            }
             else
                 Error(line, "Invalid vertex");
         }
 
         // read texture
-        else if(string(buffer,2) == "vt") {
+        else if(text.substr(0,2) == "vt") {
 			if (sscanf(buffer, "vt %f %f ",&f1, &f2) == 2)
                 texc.push_back(Vector<2,float>(f1,f2));
 			else
@@ -266,50 +728,73 @@ void OBJResource::Load() {
         }
 
         // read normals
-        else if (string(buffer,2) == "vn") {
-			if(sscanf(buffer, "vn %f %f %f", &f1, &f2, &f3) == 3)
-				norm.push_back(Vector<3,float>(f1,f2,f3));
+        else if (text.substr(0,2) == "vn") {
+			if(sscanf(buffer, "vn %f %f %f", &f1, &f2, &f3) == 3) {
+                float n[3] = { f1, f2, f3 };
+                conversion.Normal(n);
+                Vector<3,float> v(n[0], n[1], n[2]);
+                if (!conversion.IsIdentity() && v.GetLength() > 0.0f)
+                    v.Normalize();
+				norm.push_back(v);
+            }
 			else
 				Error(line, "Invalid vertex normal");
         }
 
         // read faces
-        else if (string(buffer,2) == "f ") {
+        else if (text.substr(0,2) == "f ") {
             Vector<9,int> f(0);
             //            int d1, d2, d3;
             // test that the model is triangulated
             char s1[255],s2[255],s3[255],s4[255];
-            if (sscanf(buffer, "f %s %s %s %s", s1,s2,s3,s4) != 3)
+            if (sscanf(buffer, "f %254s %254s %254s %254s", s1,s2,s3,s4) != 3)
                 Error(line, "Face has not been triangulated");
             else if ( !( sscanf(buffer, "f %d/%d/%d %d/%d/%d %d/%d/%d", &f[0],&f[1],&f[2],&f[3],&f[4],&f[5],&f[6],&f[7],&f[8]) == 9
                  || sscanf(buffer, "f %d//%d %d//%d %d//%d", &f[0],&f[2],&f[3],&f[5],&f[6],&f[8]) == 6
+                 || sscanf(buffer, "f %d/%d %d/%d %d/%d", &f[0],&f[1],&f[3],&f[4],&f[6],&f[7]) == 6
                  || sscanf(buffer, "f %d %d %d", &f[0],&f[3],&f[6]) == 3 ) ) 
                 Error(line, "Invalid face");
+            else if (!ValidFace(f, vert.size(), texc.size(), norm.size()))
+                Error(line, "Face index out of range");
             else {
-                indices.push_back(f[0]-1);
-                indices.push_back(f[1]-1);
-                indices.push_back(f[2]-1);
-                indices.push_back(f[3]-1);
-                indices.push_back(f[4]-1);
-                indices.push_back(f[5]-1);
-                indices.push_back(f[6]-1);
-                indices.push_back(f[7]-1);
-                indices.push_back(f[8]-1);
+                // flipping the winding swaps the last two corners
+                static const unsigned int order[2][3] = { { 0, 1, 2 }, { 0, 2, 1 } };
+                for (unsigned int k = 0; k < 3; ++k)
+                    for (unsigned int j = 0; j < 3; ++j)
+                        indices.push_back(f[order[options.flipWinding][k]*3 + j]-1);
+                faceMaterial.push_back(matIndex);
             }
         }
 
+        // read line and point elements, lines are split into segments
+        else if (text.substr(0,2) == "l " || text.substr(0,2) == "p ") {
+            ArenaIndices& element = buffers.element;
+            element.clear();
+            if (!ParseElement(buffer + 2, vert.size(), element) || element.empty() ||
+                (buffer[0] == 'l' && element.size() < 2))
+                Error(line, buffer[0] == 'l' ? "Invalid line element" : "Invalid point element");
+            else if (buffer[0] == 'l')
+                for (unsigned int i = 1; i < element.size(); ++i) {
+                    lineIndices.push_back(element[i-1]);
+                    lineIndices.push_back(element[i]);
+                }
+            else
+                pointIndices.insert(pointIndices.end(), element.begin(), element.end());
+        }
+
         // material resources
-        else if (string(buffer,6) == "mtllib") {
+        else if (text.substr(0,6) == "mtllib") {
             string res;
-            std::stringstream ss(buffer+7);
+            std::stringstream ss(text.substr(6));
+            Lap(profile.geometryTime);
             while (ss >> res)
                 LoadMaterialFile(File::Parent(file) + res);
         }
 
         // material elements
-        else if (string(buffer,6) == "usemtl") {
-            char name[255];
-            sscanf(buffer, "usemtl %s", name);
+        else if (text.substr(0,6) == "usemtl") {
+            char name[255] = "";
+            sscanf(buffer, "usemtl %254s", name);
             map<string, MaterialPtr>::iterator mate;
             mate = materials.find(name);
             if (mate == materials.end()) {
@@ -318,6 +803,10 @@ void OBJResource::Load() {
             } else {
                 mat = mate->second;
             }
+            matIndex = std::find(faceMaterials.begin(), faceMaterials.end(), mat)
+                - faceMaterials.begin();
+            if (matIndex == faceMaterials.size())
+                faceMaterials.push_back(mat);
         }
 
         // unsupported or invalid lines
@@ -327,47 +816,439 @@ void OBJResource::Load() {
     // close the file
     in->close();
     delete in;
+    parseTrace.Count("lines", line);
+    parseTrace.End();
+    Lap(profile.geometryTime);
+    profile.lines = line;
+    profile.vertices = vert.size();
+    profile.normals = norm.size();
+    profile.texcoords = texc.size();
+    profile.faces = faceMaterial.size();
+    profile.segments = lineIndices.size() / 2;
+    profile.points = pointIndices.size();
+    const size_t parseBytes = options.arenaBlockSize > 0 ? arena.GetSizeInBytes() : buffers.GetSizeInBytes();
+    memory.peakTemporaryBytes = parseBytes;
+
+    // move the bounding box center to the origin
+    if (options.recenter && !vert.empty()) {
+        Vector<3,float> min = vert[0], max = vert[0];
+        for (unsigned int i = 1; i < vert.size(); ++i)
+            for (unsigned int j = 0; j < 3; ++j) {
+                min[j] = std::min(min[j], vert[i][j]);
+                max[j] = std::max(max[j], vert[i][j]);
+            }
+        Vector<3,float> center = (min + max) * 0.5f;
+        for (unsigned int i = 0; i < vert.size(); ++i)
+            vert[i] -= center;
+        for (unsigned int j = 0; j < 3; ++j)
+            origin[j] += center[j];
+    }
+
+    // number the vertices used by line and point elements
+    if (!lineIndices.empty() || !pointIndices.empty()) {
+        ArenaIndices& remap = buffers.remap;
+        remap.assign(vert.size(), ~0u);
+        ArenaIndices* elements[2] = { &lineIndices, &pointIndices };
+        for (unsigned int e = 0; e < 2; ++e)
+            for (unsigned int i = 0; i < elements[e]->size(); ++i) {
+                unsigned int& v = (*elements[e])[i];
+                if (remap[v] == ~0u) {
+                    remap[v] = elementVerts.size();
+                    elementVerts.push_back(v);
+                }
+                v = remap[v];
+            }
+    }
+
+    // pack small diffuse maps of materials that do not tile
+    vector<OBJAtlasRect> atlasRects;
+    vector<unsigned int> materialRemap;
+    if (options.atlasSize > 0 && !indices.empty()) {
+        OBJTraceSpan atlasTrace("Atlas");
+        vector<bool> packable(faceMaterials.size(), true);
+        for (unsigned int face = 0; face < faceMaterial.size(); ++face)
+            for (unsigned int k = 0; k < 3; ++k) {
+                unsigned int t = indices[face*9 + k*3 + 1];
+                if (t < texc.size() &&
+                    (texc[t][0] < 0.0f || texc[t][0] > 1.0f ||
+                     texc[t][1] < 0.0f || texc[t][1] > 1.0f))
+                    packable[faceMaterial[face]] = false;
+            }
+        stats.atlasTextures = OBJTextureAtlas::Pack(faceMaterials, packable,
+                                                    options.atlasSize,
+                                                    options.atlasMaxTextureSize,
+                                                    atlasRects, materialRemap);
+        mat = faceMaterials[materialRemap[matIndex]];
+        logger.info << file << " packed " << stats.atlasTextures
+                    << " textures into atlases." << logger.end;
+    }
+    Lap(profile.processingTime);
 
     if (!indices.empty()) {
+        OBJTraceSpan expandTrace("Expand");
         unsigned int sz = indices.size()/3;
-        unsigned short* id = new unsigned short[sz];
-        float* vd = new float[sz*3];
-        float* nd = new float[sz*3];
-        float* td = new float[sz*2];
-        for (unsigned int i = 0; i < sz; ++i) {
-            Vector<3,float> v3;
-            Vector<2,float> v2;
-            id[i] = i;
-            v3 = vert[indices[i*3]];
-            v3.ToArray(&vd[i*3]);
-            v3 = norm[indices[i*3+2]];
-            v3.ToArray(&nd[i*3]);
-            v2 = texc[indices[i*3+1]];
-            v2.ToArray(&td[i*2]);
+        // when all corners use the position number for the normal and
+        // texture coordinate too, or all leave them out, the vertices of
+        // the file are kept instead of getting a vertex per corner
+        const bool noTexc = indices[1] == ~0u, noNorm = indices[2] == ~0u;
+        bool shared = atlasRects.empty();
+        for (unsigned int i = 0; shared && i < indices.size(); i += 3)
+            shared = (noTexc ? indices[i+1] == ~0u : indices[i+1] == indices[i] && indices[i] < texc.size()) &&
+                (noNorm ? indices[i+2] == ~0u : indices[i+2] == indices[i] && indices[i] < norm.size());
+        OBJMeshData data(shared ? vert.size() : sz, sz/3, options.allocator);
+        if (!vcol.empty()) {
+            data.AddColors();
+            data.byteColors = options.quantizeColors;
+        }
+        if (shared) {
+            const int count = vert.size();
+            #pragma omp parallel for
+            for (int i = 0; i < count; ++i) {
+                vert[i].ToArray(&data.vertices[i*3]);
+                Vector<3,float> n = !noNorm && unsigned(i) < norm.size() ? norm[i] : Vector<3,float>(0.0f);
+                n.ToArray(&data.normals[i*3]);
+                Vector<2,float> t = !noTexc && unsigned(i) < texc.size() ? texc[i] : Vector<2,float>(0.0f);
+                t.ToArray(&data.texcoords[i*2]);
+                if (data.colors)
+                    vcol[i].ToArray(&data.colors[i*3]);
+            }
+        }
+        boost::unordered_set<OBJFaceKey>& faces = buffers.faces;
+        vector<unsigned int> objectStarts;
+        unsigned int out = 0, object = 0;
+        for (unsigned int face = 0; face < sz/3; ++face) {
+            const unsigned int* f = &indices[face*9];
+            for (; object < objects.size() && objects[object] == face; ++object)
+                objectStarts.push_back(out/3);
+            if (options.removeDegenerate) {
+                // collapsed corners or no area
+                if (f[0] == f[3] || f[0] == f[6] || f[3] == f[6] ||
+                    ((vert[f[3]] - vert[f[0]]) % (vert[f[6]] - vert[f[0]])).GetLength() * 0.5f
+                    <= options.degenerateArea) {
+                    stats.degenerateTriangles++;
+                    continue;
+                }
+                if (!faces.insert(OBJFaceKey(f)).second) {
+                    stats.duplicateTriangles++;
+                    continue;
+                }
+            }
+            unsigned int m = faceMaterial[face];
+            const OBJAtlasRect* rect = atlasRects.empty() || !atlasRects[m].packed ? NULL : &atlasRects[m];
+            data.materials[out/3] = materialRemap.empty() ? m : materialRemap[m];
+            if (shared) {
+                for (unsigned int k = 0; k < 3; ++k, ++out)
+                    data.indices[out] = f[k*3];
+                continue;
+            }
+            for (unsigned int k = 0; k < 3; ++k, ++out) {
+                // corners without a normal or texture coordinate get zeros
+                Vector<3,float> v3;
+                Vector<2,float> v2(0.0f);
+                data.indices[out] = out;
+                v3 = vert[f[k*3]];
+                v3.ToArray(&data.vertices[out*3]);
+                if (data.colors)
+                    vcol[f[k*3]].ToArray(&data.colors[out*3]);
+                v3 = f[k*3+2] < norm.size() ? norm[f[k*3+2]] : Vector<3,float>(0.0f);
+                v3.ToArray(&data.normals[out*3]);
+                if (f[k*3+1] < texc.size())
+                    v2 = texc[f[k*3+1]];
+                if (rect) {
+                    // move the coordinate into the atlas
+                    v2[0] = rect->offset[0] + v2[0] * rect->scale[0];
+                    v2[1] = rect->offset[1] + v2[1] * rect->scale[1];
+                }
+                v2.ToArray(&data.texcoords[out*2]);
+            }
+        }
+        if (!shared) data.vertexCount = out;
+        data.triangleCount = out/3;
+        expandTrace.Count("vertices", data.vertexCount);
+        expandTrace.Count("triangles", data.triangleCount);
+        expandTrace.End();
+        memory.peakTemporaryBytes = parseBytes + data.GetSizeInBytes();
+
+        // the parse data is consumed, except the vertices that line and
+        // point elements still need
+        Release(indices);
+        Release(faceMaterial);
+        Release(norm);
+        Release(texc);
+        if (elementVerts.empty()) {
+            Release(vert);
+            Release(vcol);
+        }
+        if (options.removeDegenerate)
+            logger.info << file << " removed " << stats.degenerateTriangles
+                        << " degenerate and " << stats.duplicateTriangles
+                        << " duplicate triangles." << logger.end;
+
+        // optional passes over the indexed data
+        if (options.convexHulls) {
+            OBJTraceSpan hullTrace("ConvexHulls");
+            // triangles before the first object form an object of their own
+            vector<unsigned int> starts = objectStarts;
+            if (starts.empty() || starts[0] != 0)
+                starts.insert(starts.begin(), 0);
+            OBJConvexHull::Build(data, starts, hulls);
+            stats.convexHulls = hulls.size();
+            logger.info << file << " computed convex hulls of " << stats.convexHulls
+                        << " of " << starts.size() << " objects." << logger.end;
+        }
+        if (options.detectInstances && !query) {
+            OBJTraceSpan instanceTrace("Instances");
+            instances = OBJInstancer::Extract(data, objectStarts, faceMaterials,
+                                              options.instanceEpsilon,
+                                              options.instanceMinCount,
+                                              stats.instancedObjects, instanced);
+            logger.info << file << " replaced " << stats.instancedObjects
+                        << " objects by instances." << logger.end;
+        }
+        if (options.weld) {
+            OBJTraceSpan weldTrace("Weld");
+            unsigned int before = data.vertexCount;
+            stats.weldedVertices = OBJWeld::Weld(data, options.weldEpsilon,
+                                                  options.weldNormalEpsilon,
+                                                  options.weldTexcoordEpsilon);
+            logger.info << file << " welded " << stats.weldedVertices
+                        << " of " << before << " vertices." << logger.end;
+        }
+        if (options.spatialSort) {
+            OBJTraceSpan sortTrace("SpatialSort");
+            OBJSpatialSort::Sort(data);
+        }
+
+        Lap(profile.processingTime);
+
+        // 16 bit indices cannot reach past 65535 vertices, so larger
+        // meshes are split into chunks that each fit
+        unsigned int chunkSize = options.chunkSize;
+        if (chunkSize == 0 && !query && data.vertexCount + elementVerts.size() > 0xFFFF) {
+            logger.warning << file << " has " << data.vertexCount + elementVerts.size()
+                           << " vertices, more than 16 bit indices reach, and is"
+                           << " split into chunks." << logger.end;
+            chunkSize = 0xFFFF / 3;
+        }
+
+        // split large meshes into a subtree of cullable chunks
+        if (chunkSize > 0 && !query) {
+            OBJTraceSpan chunkTrace("Chunk");
+            node = OBJChunker::Build(data, faceMaterials, chunkSize,
+                                     options.chunkDepth, chunks);
+            chunkTrace.Count("chunks", chunks.size());
+        } else {
+            if (options.buildAdjacency) {
+                OBJTraceSpan adjacencyTrace("Adjacency");
+                adjacency = OBJAdjacencyPtr(new OBJAdjacency(data.indices, data.triangleCount,
+                                                             data.vertices, data.vertexCount));
+            }
+
+            // line and point elements share the triangle vertex data
+            if (!elementVerts.empty()) {
+                elementBase = data.AddVertices(elementVerts.size());
+                for (unsigned int i = 0; i < elementVerts.size(); ++i) {
+                    vert[elementVerts[i]].ToArray(&data.vertices[(elementBase + i)*3]);
+                    if (data.colors)
+                        vcol[elementVerts[i]].ToArray(&data.colors[(elementBase + i)*3]);
+                }
+            }
+
+            // strips are only kept when they need fewer indices
+            vector<unsigned int> strip;
+            sz = data.triangleCount*3;
+            if (options.stripify && data.vertexCount < OBJStripifier::RESTART) {
+                OBJTraceSpan stripTrace("Strip");
+                unsigned int strips = OBJStripifier::Stripify(data.indices, data.triangleCount,
+                                                              data.vertexCount, strip);
+                stats.triangleIndices = sz;
+                stats.stripIndices = strip.size();
+                logger.info << file << " stripified " << sz << " indices into "
+                            << strips << " strips of " << strip.size()
+                            << " indices." << logger.end;
+                if (strip.size() < sz)
+                    primitive = TRIANGLE_STRIP;
+                else
+                    strip.clear();
+            }
+
+            // keep the data for LoadInto() or hand the arrays over to
+            // the data blocks
+            const unsigned int* src = strip.empty() ? data.indices : &strip[0];
+            sz = strip.empty() ? sz : strip.size();
+            if (query) {
+                pendingIndices.assign(src, src + sz);
+                pending = new OBJMeshData(0, 0);
+                pending->Swap(data);
+            } else {
+                unsigned short* id = new unsigned short[sz];
+                for (unsigned int i = 0; i < sz; ++i)
+                    id[i] = src[i];
+                is = new Indices(sz, id);
+                vs = data.TakeVertices();
+                ns = data.TakeNormals();
+                ts = data.TakeTexcoords();
+                cs = data.TakeColors();
+            }
         }
-        is = new Indices(sz, id);
-        vs = new DataBlock<3,float>(sz, vd);
-        ns = new DataBlock<3,float>(sz, nd);
-        ts = new DataBlock<2,float>(sz, td);
     }
 
-    IDataBlockList texlist;
-    texlist.push_back(Float2DataBlockPtr(ts));
-    GeometrySetPtr gs = GeometrySetPtr(new GeometrySet(Float3DataBlockPtr(vs), Float3DataBlockPtr(ns), texlist, Float3DataBlockPtr()));
-    // // create a new mesh
-    mesh = MeshPtr(new Mesh(IndicesPtr(is), TRIANGLES, gs, mat));
-    node = new MeshNode(mesh);
+    // the buffer API stops here and keeps the data for LoadInto()
+    OBJTraceSpan buildTrace("Build");
+    if (query) {
+        if (!pending) {
+            // files with nothing but vertices get a point element of
+            // each vertex, as Load() makes them a point cloud
+            if (elementVerts.empty()) {
+                for (unsigned int i = 0; i < vert.size(); ++i) {
+                    elementVerts.push_back(i);
+                    pointIndices.push_back(i);
+                }
+                stats.cloudPoints = vert.size();
+            }
+            pending = new OBJMeshData(0, 0, options.allocator);
+            if (!vcol.empty()) pending->AddColors();
+            elementBase = pending->AddVertices(elementVerts.size());
+            for (unsigned int i = 0; i < elementVerts.size(); ++i) {
+                vert[elementVerts[i]].ToArray(&pending->vertices[i*3]);
+                if (pending->colors)
+                    vcol[elementVerts[i]].ToArray(&pending->colors[i*3]);
+            }
+        }
+        for (unsigned int i = 0; i < lineIndices.size(); ++i)
+            pendingLines.push_back(elementBase + lineIndices[i]);
+        for (unsigned int i = 0; i < pointIndices.size(); ++i)
+            pendingPoints.push_back(elementBase + pointIndices[i]);
+        sizes = OBJBufferSizes();
+        sizes.vertexCount = pending->vertexCount;
+        sizes.indexCount = pendingIndices.size();
+        sizes.lineIndexCount = pendingLines.size();
+        sizes.pointIndexCount = pendingPoints.size();
+        sizes.primitive = primitive;
+        sizes.colors = pending->colors != NULL;
+        sizes.material = mat;
+        buildTrace.End();
+        Lap(profile.buildingTime);
+        LoadDone(start, trace);
+        setlocale(LC_NUMERIC, lc->decimal_point);
+        return;
+    }
+
+    // files with nothing but vertices are point clouds
+    if (!node && !is && elementVerts.empty() && !vert.empty()) {
+        stats.cloudPoints = vert.size();
+        node = OBJPointCloud::Build(&vert[0], vcol.empty() ? NULL : &vcol[0],
+                                    vert.size(), options.quantizeColors, mat, cloud);
+    }
+    GeometrySetPtr shared;
+    if (!node && (is || elementVerts.empty())) {
+        IDataBlockList texlist;
+        texlist.push_back(ts);
+        shared = GeometrySetPtr(new GeometrySet(vs, ns, texlist, cs));
+        // nothing is left when every object became an instance
+        if (instances && is->GetSize() == 0)
+            delete is;
+        else {
+            // // create a new mesh
+            mesh = MeshPtr(new Mesh(IndicesPtr(is), primitive, shared, mat));
+            node = new MeshNode(mesh);
+        }
+    }
+    if (!elementVerts.empty()) {
+        if (!shared && elementVerts.size() > 0xFFFF) {
+            logger.warning << file << " has " << elementVerts.size()
+                           << " line and point vertices, more than 16 bit indices"
+                           << " reach, and they are split into several meshes."
+                           << logger.end;
+            SplitElements(lineIndices, 2, LINES, elementVerts, vert, vcol, options, mat, lines);
+            SplitElements(pointIndices, 1, POINTS, elementVerts, vert, vcol, options, mat, points);
+        } else {
+            // share the vertices of a single triangle mesh
+            GeometrySetPtr gs = shared ? shared
+                : ElementGeometry(&elementVerts[0], elementVerts.size(), vert, vcol, options);
+            if (!lineIndices.empty())
+                lines.push_back(ElementMesh(lineIndices, elementBase, LINES, gs, mat));
+            if (!pointIndices.empty())
+                points.push_back(ElementMesh(pointIndices, elementBase, POINTS, gs, mat));
+        }
+        ISceneNode* root = new SceneNode();
+        if (node) root->AddNode(node);
+        for (unsigned int i = 0; i < lines.size(); ++i)
+            root->AddNode(new MeshNode(lines[i]));
+        for (unsigned int i = 0; i < points.size(); ++i)
+            root->AddNode(new MeshNode(points[i]));
+        node = root;
+    }
+    if (instances) {
+        ISceneNode* root = new SceneNode();
+        if (node) root->AddNode(node);
+        root->AddNode(instances);
+        node = root;
+    }
+    if (options.recenter) node = Offset(node, origin);
+    buildTrace.End();
+    Lap(profile.buildingTime);
+    LoadDone(start, trace);
     // change back the default floating point decimal symboly
     setlocale(LC_NUMERIC, lc->decimal_point);
 }
 
+/**
+ * Set the load options used by the next call to Load().
+ */
+void OBJResource::SetLoadOptions(OBJLoadOptions options) {
+    this->options = options;
+}
+
+/**
+ * Get the load options.
+ */
+OBJLoadOptions OBJResource::GetLoadOptions() {
+    return options;
+}
+
+/**
+ * Get the statistics of the last call to Load().
+ */
+OBJLoadStatistics OBJResource::GetLoadStatistics() {
+    return stats;
+}
+
 /**
  * Unload the resource.
- * Resets the face collection. Does not delete the face set.
+ * Resets the face collection and the material map. Does not delete
+ * the face set.
  */
 void OBJResource::Unload() {
     mesh = MeshPtr();
+    lines.clear();
+    points.clear();
+    cloud.clear();
+    origin = Vector<3,double>(0.0);
+    hulls.clear();
+    delete pending;
+    pending = NULL;
+    vector<unsigned int>().swap(pendingIndices);
+    vector<unsigned int>().swap(pendingLines);
+    vector<unsigned int>().swap(pendingPoints);
     node = NULL;
+    chunks.clear();
+    instanced.clear();
+    adjacency = OBJAdjacencyPtr();
+    materials.clear();
+    Account();
+}
+
+/**
+ * Free the parse buffers kept by the calling thread.
+ * Loads keep the buffers of their thread for the next load, so call
+ * this after loading a large file, and on threads that are about to
+ * exit, to give the memory back.
+ */
+void OBJResource::TrimParseBuffers() {
+    if (!threadBuffers || threadBuffers->inUse) return;
+    delete threadBuffers;
+    threadBuffers = NULL;
 }
 
 // /**
@@ -388,6 +1269,295 @@ ISceneNode* OBJResource::GetSceneNode() {
     return node;
 }
 
+/**
+ * Get the chunks of the loaded OBJ data.
+ * The list is only filled when the resource is loaded with a chunk
+ * size in the load options, in which case the scene node is the
+ * root of the chunk octree.
+ *
+ * @return List of chunks with their bounds and meshes
+ */
+const vector<OBJChunk>& OBJResource::GetChunks() {
+    return chunks;
+}
+
+/**
+ * Get the meshes of the loaded OBJ data.
+ * This is the single mesh of the resource, or the chunk meshes when
+ * it is loaded with chunking, followed by the line and point element
+ * meshes, or the point meshes of a point cloud. Instanced objects
+ * are not included as they are only meaningful with their
+ * transformations.
+ *
+ * @return List of meshes
+ */
+vector<MeshPtr> OBJResource::GetMeshes() {
+    vector<MeshPtr> meshes;
+    if (mesh) meshes.push_back(mesh);
+    for (unsigned int i = 0; i < chunks.size(); ++i)
+        meshes.push_back(chunks[i].mesh);
+    meshes.insert(meshes.end(), lines.begin(), lines.end());
+    meshes.insert(meshes.end(), points.begin(), points.end());
+    meshes.insert(meshes.end(), cloud.begin(), cloud.end());
+    return meshes;
+}
+
+/**
+ * Get the half-edge adjacency of the loaded mesh.
+ * The adjacency is only built when the resource is loaded with
+ * buildAdjacency set and without chunking. Half-edge h belongs to
+ * triangle h/3 of the triangle list, which is the mesh index buffer
+ * unless the mesh was converted to strips.
+ *
+ * @return Adjacency or a NULL pointer
+ */
+OBJAdjacencyPtr OBJResource::GetAdjacency() {
+    return adjacency;
+}
+
+/**
+ * Get the offset subtracted from the positions when the resource is
+ * loaded with recenter set. The scene node is translated by the
+ * offset, but applications that need the full precision, e.g. to
+ * render relative to the camera, should use this double precision
+ * value instead of the translation.
+ *
+ * @return Offset of the positions in the file
+ */
+Vector<3,double> OBJResource::GetOrigin() {
+    return origin;
+}
+
+/**
+ * Get the convex hulls of the objects in the loaded OBJ data.
+ * The hulls are only computed when the resource is loaded with
+ * convexHulls set. Objects are numbered in file order, with any
+ * triangles before the first object or group counted as object 0,
+ * and objects too flat to enclose a volume have no hull. The hulls
+ * use the same coordinates as the meshes.
+ *
+ * @return List of hulls
+ */
+const vector<OBJHull>& OBJResource::GetConvexHulls() {
+    return hulls;
+}
+
+/**
+ * Parse the file and get the sizes of the streams LoadInto() will
+ * write, so the caller can allocate its buffers.
+ *
+ * The file is parsed and processed as by Load(), except that no
+ * meshes or scene nodes are created. Instancing, chunking and the
+ * point cloud fast path are skipped as they produce more than one
+ * mesh. Files with nothing but vertices are written as a point
+ * element of each vertex.
+ *
+ * A resource loaded with Load() has nothing to write, so its sizes
+ * are all zero until it is unloaded.
+ *
+ * @return Sizes of the vertex and index streams
+ */
+OBJBufferSizes OBJResource::QuerySizes() {
+    if (node) {
+        logger.warning << file << " is loaded as a scene, unload it before "
+                       << "loading it into buffers." << logger.end;
+        return OBJBufferSizes();
+    }
+    if (!pending) {
+        query = true;
+        Load();
+        query = false;
+    }
+    return pending ? sizes : OBJBufferSizes();
+}
+
+/**
+ * Write indices with the given index size. Strip restarts become the
+ * largest index of the size.
+ */
+static void WriteIndices(const vector<unsigned int>& src, void* dst,
+                         unsigned int size, bool strip) {
+    if (!dst) return;
+    for (unsigned int i = 0; i < src.size(); ++i) {
+        unsigned int index = strip && src[i] == OBJStripifier::RESTART ? ~0u : src[i];
+        if (size == 2) ((unsigned short*)dst)[i] = index;
+        else ((unsigned int*)dst)[i] = index;
+    }
+}
+
+/**
+ * Write the loaded data into caller owned buffers.
+ *
+ * QuerySizes() is called first if it has not been, and the buffers
+ * must hold the sizes it returns. The data kept since QuerySizes() is
+ * released afterwards, so calling LoadInto() again parses the file
+ * again.
+ *
+ * @param layout Where and how to write each stream
+ * @return False if there is nothing to write, e.g. because the
+ *         resource is loaded with Load(), or if the vertices do not
+ *         fit the index size
+ */
+bool OBJResource::LoadInto(const OBJBufferLayout& layout) {
+    QuerySizes();
+    if (!pending) return false;
+    if ((layout.indexSize == 2 && sizes.vertexCount > 0xFFFF) ||
+        (layout.indexSize != 2 && layout.indexSize != 4)) {
+        logger.warning << file << " has " << sizes.vertexCount
+                       << " vertices, which do not fit indices of "
+                       << layout.indexSize << " bytes." << logger.end;
+        return false;
+    }
+
+    const OBJMeshData& data = *pending;
+    const unsigned int ps = layout.positionStride ? layout.positionStride : 3 * sizeof(float);
+    const unsigned int ns = layout.normalStride ? layout.normalStride : 3 * sizeof(float);
+    const unsigned int ts = layout.texcoordStride ? layout.texcoordStride : 2 * sizeof(float);
+    const unsigned int cs = layout.colorStride ? layout.colorStride
+        : layout.colorBytes ? 4 : 3 * sizeof(float);
+    const int count = data.vertexCount;
+    #pragma omp parallel for
+    for (int i = 0; i < count; ++i) {
+        if (layout.positions)
+            std::copy(data.vertices + i*3, data.vertices + i*3 + 3,
+                      (float*)((char*)layout.positions + i * ps));
+        if (layout.normals)
+            std::copy(data.normals + i*3, data.normals + i*3 + 3,
+                      (float*)((char*)layout.normals + i * ns));
+        if (layout.texcoords)
+            std::copy(data.texcoords + i*2, data.texcoords + i*2 + 2,
+                      (float*)((char*)layout.texcoords + i * ts));
+        if (!layout.colors) continue;
+        char* c = (char*)layout.colors + i * cs;
+        for (unsigned int j = 0; j < 3; ++j) {
+            float v = data.colors ? data.colors[i*3+j] : 1.0f;
+            if (layout.colorBytes)
+                ((unsigned char*)c)[j] = (unsigned char)(std::min(std::max(v, 0.0f), 1.0f) * 255.0f + 0.5f);
+            else
+                ((float*)c)[j] = v;
+        }
+        if (layout.colorBytes) ((unsigned char*)c)[3] = 255;
+    }
+    WriteIndices(pendingIndices, layout.indices, layout.indexSize,
+                 sizes.primitive == TRIANGLE_STRIP);
+    WriteIndices(pendingLines, layout.lineIndices, layout.indexSize, false);
+    WriteIndices(pendingPoints, layout.pointIndices, layout.indexSize, false);
+
+    delete pending;
+    pending = NULL;
+    vector<unsigned int>().swap(pendingIndices);
+    vector<unsigned int>().swap(pendingLines);
+    vector<unsigned int>().swap(pendingPoints);
+    Account();
+    return true;
+}
+
+/**
+ * Get the profile of the last call to Load().
+ */
+OBJLoadProfile OBJResource::GetLoadProfile() {
+    return profile;
+}
+
+/**
+ * Add the time since the last lap to a phase of the load profile,
+ * if profiling is enabled.
+ */
+void OBJResource::Lap(boost::uint64_t& phase) {
+    if (!options.profile && !options.logProfile) return;
+    Time now = Timer::GetTime();
+    phase += (now - lapStart).AsInt();
+    lapStart = now;
+}
+
+/**
+ * Finish a load by recounting the memory and the total time, and
+ * log the profile if asked to.
+ *
+ * @param start Time the load started at
+ * @param trace Span of the load, ended with the sizes of the file
+ */
+void OBJResource::LoadDone(Time start, OBJTraceSpan& trace) {
+    trace.Count("bytes", profile.bytesRead);
+    trace.Count("vertices", profile.vertices);
+    trace.Count("faces", profile.faces);
+    trace.End();
+    ReportErrors();
+    Account();
+    if (!options.profile && !options.logProfile) return;
+    profile.totalTime = (Timer::GetTime() - start).AsInt();
+    if (options.logProfile)
+        logger.debug << file << " loaded in " << profile.totalTime << " us:"
+                     << " open " << profile.openTime
+                     << ", geometry " << profile.geometryTime
+                     << ", materials " << profile.materialTime
+                     << ", textures " << profile.textureTime
+                     << ", processing " << profile.processingTime
+                     << ", building " << profile.buildingTime
+                     << "; read " << profile.bytesRead << " bytes, "
+                     << profile.lines << " lines, " << profile.vertices << " vertices, "
+                     << profile.faces << " faces, " << profile.materials << " materials, "
+                     << profile.textures << " textures." << logger.end;
+}
+
+/**
+ * Get the errors found by the last load, one entry per kind.
+ */
+const vector<OBJLoadError>& OBJResource::GetErrors() {
+    return errors;
+}
+
+/**
+ * Get the memory held by the loaded data of the resource and the
+ * peak temporary memory of its last load.
+ */
+OBJMemoryUsage OBJResource::GetMemoryUsage() {
+    return memory;
+}
+
+/**
+ * Recount the memory held by the resource and move the totals of
+ * all resources by the difference.
+ */
+void OBJResource::Account() {
+    OBJMemoryUsage usage;
+    usage.peakTemporaryBytes = memory.peakTemporaryBytes;
+    usage.resources = node || pending ? 1 : 0;
+    boost::unordered_set<const void*> seen;
+    vector<MeshPtr> meshes = GetMeshes();
+    meshes.insert(meshes.end(), instanced.begin(), instanced.end());
+    for (unsigned int i = 0; i < meshes.size(); ++i) {
+        usage.indexBytes += BlockBytes(meshes[i]->GetIndices(), seen);
+        GeometrySetPtr gs = meshes[i]->GetGeometrySet();
+        usage.vertexBytes += BlockBytes(gs->GetVertices(), seen);
+        usage.vertexBytes += BlockBytes(gs->GetNormals(), seen);
+        usage.vertexBytes += BlockBytes(gs->GetColors(), seen);
+        IDataBlockList texlist = gs->GetTexCoords();
+        for (IDataBlockList::iterator t = texlist.begin(); t != texlist.end(); ++t)
+            usage.vertexBytes += BlockBytes(*t, seen);
+        usage.materialBytes += MaterialBytes(meshes[i]->GetMaterial(), seen);
+    }
+    for (map<string, MaterialPtr>::iterator m = materials.begin(); m != materials.end(); ++m)
+        usage.materialBytes += MaterialBytes(m->second, seen);
+
+    if (adjacency)
+        usage.auxiliaryBytes += (adjacency->origin.capacity() + adjacency->twin.capacity() +
+                                 adjacency->position.capacity() + adjacency->vertexEdge.capacity())
+            * sizeof(unsigned int);
+    for (unsigned int i = 0; i < hulls.size(); ++i)
+        usage.auxiliaryBytes += sizeof(OBJHull) + hulls[i].vertices.capacity() * sizeof(float)
+            + hulls[i].indices.capacity() * sizeof(unsigned int);
+    if (pending)
+        usage.auxiliaryBytes += pending->GetSizeInBytes();
+    usage.auxiliaryBytes += (pendingIndices.capacity() + pendingLines.capacity() +
+                             pendingPoints.capacity()) * sizeof(unsigned int);
+
+    AddToTotals(memory, -1);
+    AddToTotals(usage, 1);
+    AtomicMax(totalPeakTemporaryBytes, usage.peakTemporaryBytes);
+    memory = usage;
+}
+
 
 } // NS Resources
 } // NS OpenEngine
@@ -15,7 +15,15 @@
 #include <Resources/IResourcePlugin.h>
 #include <Geometry/Material.h>
 #include <Geometry/Mesh.h>
+#include <Math/Vector.h>
+#include <Math/Matrix.h>
+#include <Utils/Timer.h>
+#include <Resources/OBJChunker.h>
+#include <Resources/OBJAdjacency.h>
+#include <Resources/OBJConvexHull.h>
+#include <Resources/OBJAllocator.h>
 
+#include <boost/cstdint.hpp>
 #include <string>
 #include <vector>
 #include <map>
@@ -24,8 +32,248 @@ namespace OpenEngine {
 namespace Resources {
 
 using namespace OpenEngine::Geometry;
+using OpenEngine::Math::Matrix;
 using namespace std;
 
+/**
+ * Optional processing done by OBJResource::Load().
+ * Everything is disabled by default so the file is loaded exactly
+ * as it is written.
+ */
+struct OBJLoadOptions {
+    unsigned int atlasSize;   //!< size of texture atlases, 0 disables packing
+    unsigned int atlasMaxTextureSize; //!< largest texture packed in an atlas
+    bool removeDegenerate;    //!< drop degenerate and duplicate triangles
+    float degenerateArea;     //!< largest area of a degenerate triangle
+    bool detectInstances;     //!< share meshes between congruent objects
+    float instanceEpsilon;    //!< largest local difference of instances
+    unsigned int instanceMinCount; //!< fewest copies worth instancing
+    bool weld;                //!< merge vertices equal within the weld tolerances
+    float weldEpsilon;        //!< largest position difference when welding
+    float weldNormalEpsilon;  //!< largest normal difference when welding
+    float weldTexcoordEpsilon; //!< largest texture coordinate or colour difference when welding
+    bool spatialSort;         //!< sort triangles and vertices in Morton order
+    unsigned int chunkSize;   //!< max triangles per chunk, 0 disables chunking
+    unsigned int chunkDepth;  //!< max depth of the chunk octree
+    bool buildAdjacency;      //!< build half-edge adjacency of the mesh
+    bool pointCloud;          //!< only load the vertices as a point cloud
+    bool quantizeColors;      //!< store vertex colours as 8 bit RGBA
+    bool recenter;            //!< center the positions around the origin
+    bool swapYZ;              //!< swap the y and z axes
+    float scale;              //!< uniform scale applied after the swap
+    Matrix<4,4,float> transform; //!< transformation applied after the scale
+    bool flipWinding;         //!< reverse the corner order of faces
+    bool stripify;            //!< use triangle strips when they are smaller
+    bool convexHulls;         //!< compute the convex hull of each object
+    OBJAllocatorPtr allocator; //!< source of the mesh arrays, NULL for new[]
+    unsigned int arenaBlockSize; //!< arena block size for parse data, 0 for the heap
+    bool profile;             //!< time the phases of each load
+    bool logProfile;          //!< log the load profile at debug level
+    unsigned int errorLines;  //!< line numbers kept for each kind of error
+
+    OBJLoadOptions()
+        : atlasSize(0)
+        , atlasMaxTextureSize(256)
+        , removeDegenerate(false)
+        , degenerateArea(1e-12f)
+        , detectInstances(false)
+        , instanceEpsilon(1e-4f)
+        , instanceMinCount(2)
+        , weld(false)
+        , weldEpsilon(0.0f)
+        , weldNormalEpsilon(0.0f)
+        , weldTexcoordEpsilon(0.0f)
+        , spatialSort(false)
+        , chunkSize(0)
+        , chunkDepth(8)
+        , buildAdjacency(false)
+        , pointCloud(false)
+        , quantizeColors(false)
+        , recenter(false)
+        , swapYZ(false)
+        , scale(1.0f)
+        , flipWinding(false)
+        , stripify(false)
+        , convexHulls(false)
+        , arenaBlockSize(0)
+        , profile(false)
+        , logProfile(false)
+        , errorLines(10) {}
+};
+
+/**
+ * Counts reported by the last call to OBJResource::Load().
+ */
+struct OBJLoadStatistics {
+    unsigned int atlasTextures;       //!< textures packed into atlases
+    unsigned int degenerateTriangles; //!< triangles dropped for having no area
+    unsigned int duplicateTriangles;  //!< triangles dropped as exact duplicates
+    unsigned int instancedObjects;    //!< objects replaced by instances
+    unsigned int weldedVertices;      //!< vertices merged by welding
+    unsigned int cloudPoints;         //!< points loaded as a point cloud
+    unsigned int triangleIndices;     //!< indices of the triangle list
+    unsigned int stripIndices;        //!< indices of the strips, restarts included
+    unsigned int convexHulls;         //!< objects given a convex hull
+
+    OBJLoadStatistics()
+        : atlasTextures(0)
+        , degenerateTriangles(0)
+        , duplicateTriangles(0)
+        , instancedObjects(0)
+        , weldedVertices(0)
+        , cloudPoints(0)
+        , triangleIndices(0)
+        , stripIndices(0)
+        , convexHulls(0) {}
+};
+
+/**
+ * A kind of error found by the last call to OBJResource::Load(),
+ * such as invalid faces, with the number of lines it was found on.
+ */
+struct OBJLoadError {
+    string file;                //!< OBJ or material file of the lines
+    string message;             //!< what is wrong with the lines
+    unsigned int count;         //!< lines with the error
+    vector<unsigned int> lines; //!< the first lines, see OBJLoadOptions::errorLines
+
+    OBJLoadError(string file, string message)
+        : file(file), message(message), count(0) {}
+};
+
+/**
+ * Where the time of the last call to OBJResource::Load() went, and
+ * how much it read.
+ * The times are in microseconds and are only recorded when the load
+ * options ask for profiling. The counts are always recorded.
+ */
+struct OBJLoadProfile {
+    boost::uint64_t openTime;       //!< opening the OBJ file
+    boost::uint64_t geometryTime;   //!< parsing the OBJ records
+    boost::uint64_t materialTime;   //!< parsing material files
+    boost::uint64_t textureTime;    //!< creating texture and shader resources
+    boost::uint64_t processingTime; //!< expanding faces and the optional passes
+    boost::uint64_t buildingTime;   //!< creating data blocks, meshes and nodes
+    boost::uint64_t totalTime;      //!< the whole load
+    boost::uint64_t bytesRead;      //!< bytes of OBJ and material text read
+    unsigned int lines;             //!< lines of the OBJ file
+    unsigned int vertices;          //!< vertex records
+    unsigned int normals;           //!< normal records
+    unsigned int texcoords;         //!< texture coordinate records
+    unsigned int faces;             //!< triangles read
+    unsigned int segments;          //!< line segments of line elements
+    unsigned int points;            //!< points of point elements
+    unsigned int materialFiles;     //!< material files read
+    unsigned int materials;         //!< materials defined
+    unsigned int textures;          //!< texture and shader resources created
+
+    OBJLoadProfile()
+        : openTime(0)
+        , geometryTime(0)
+        , materialTime(0)
+        , textureTime(0)
+        , processingTime(0)
+        , buildingTime(0)
+        , totalTime(0)
+        , bytesRead(0)
+        , lines(0)
+        , vertices(0)
+        , normals(0)
+        , texcoords(0)
+        , faces(0)
+        , segments(0)
+        , points(0)
+        , materialFiles(0)
+        , materials(0)
+        , textures(0) {}
+};
+
+/**
+ * Memory held by loaded OBJ data, in bytes.
+ * Data blocks shared by several meshes of a resource are counted
+ * once, while textures shared by several resources are counted for
+ * each of them.
+ */
+struct OBJMemoryUsage {
+    boost::uint64_t vertexBytes;    //!< vertex attribute data blocks
+    boost::uint64_t indexBytes;     //!< index blocks
+    boost::uint64_t materialBytes;  //!< materials and their loaded textures
+    boost::uint64_t auxiliaryBytes; //!< adjacency, hulls and data waiting for LoadInto()
+    boost::uint64_t peakTemporaryBytes; //!< largest parse and intermediate data of a load
+    unsigned int resources;         //!< loaded resources
+
+    OBJMemoryUsage()
+        : vertexBytes(0)
+        , indexBytes(0)
+        , materialBytes(0)
+        , auxiliaryBytes(0)
+        , peakTemporaryBytes(0)
+        , resources(0) {}
+
+    /**
+     * Get the bytes held after loading, temporaries excluded.
+     */
+    boost::uint64_t GetTotalBytes() const {
+        return vertexBytes + indexBytes + materialBytes + auxiliaryBytes;
+    }
+};
+
+/**
+ * Sizes of the streams written by OBJResource::LoadInto().
+ */
+struct OBJBufferSizes {
+    unsigned int vertexCount;     //!< vertices of every attribute
+    unsigned int indexCount;      //!< triangle or strip indices
+    unsigned int lineIndexCount;  //!< line element indices, two per segment
+    unsigned int pointIndexCount; //!< point element indices
+    GeometryPrimitive primitive;  //!< TRIANGLES or TRIANGLE_STRIP
+    bool colors;                  //!< the file has vertex colours
+    MaterialPtr material;         //!< material of the mesh
+
+    OBJBufferSizes()
+        : vertexCount(0)
+        , indexCount(0)
+        , lineIndexCount(0)
+        , pointIndexCount(0)
+        , primitive(TRIANGLES)
+        , colors(false) {}
+};
+
+/**
+ * Caller owned memory written by OBJResource::LoadInto().
+ *
+ * Each attribute is written through its pointer with a stride in
+ * bytes between consecutive vertices, so attributes may be
+ * interleaved in one buffer or kept in separate ones. A stride of 0
+ * means tightly packed and a NULL pointer skips the stream.
+ */
+struct OBJBufferLayout {
+    float* positions;          //!< three floats per vertex
+    unsigned int positionStride;
+    float* normals;            //!< three floats per vertex
+    unsigned int normalStride;
+    float* texcoords;          //!< two floats per vertex
+    unsigned int texcoordStride;
+    void* colors;              //!< three floats or four bytes per vertex
+    unsigned int colorStride;
+    bool colorBytes;           //!< write colours as 8 bit RGBA
+    void* indices;             //!< triangle or strip indices
+    void* lineIndices;         //!< line element indices
+    void* pointIndices;        //!< point element indices
+    unsigned int indexSize;    //!< bytes per index, 2 or 4
+
+    OBJBufferLayout()
+        : positions(NULL), positionStride(0)
+        , normals(NULL), normalStride(0)
+        , texcoords(NULL), texcoordStride(0)
+        , colors(NULL), colorStride(0), colorBytes(false)
+        , indices(NULL), lineIndices(NULL), pointIndices(NULL)
+        , indexSize(2) {}
+};
+
+class OBJMeshData;
+class OBJTraceSpan;
+
 /**
  * OBJ-model resource.
  *
@@ -37,21 +285,59 @@ private:
     // inner material structure
 
     string file;                      //!< obj file path
+    OBJLoadOptions options;           //!< load options
+    OBJLoadStatistics stats;          //!< statistics of the last load
+    vector<OBJLoadError> errors;      //!< errors of the last load
     MeshPtr mesh;                       //!< the mesh
+    vector<MeshPtr> lines;            //!< meshes of the line elements
+    vector<MeshPtr> points;           //!< meshes of the point elements
+    vector<MeshPtr> cloud;            //!< meshes of a point cloud
+    vector<MeshPtr> instanced;        //!< shared meshes of instanced objects
     ISceneNode* node;                 //!< the scene node
     map<string, MaterialPtr> materials; //!< resources material map
+    vector<OBJChunk> chunks;          //!< chunks when loaded with chunking
+    OBJAdjacencyPtr adjacency;        //!< adjacency when requested
+    Vector<3,double> origin;          //!< offset subtracted from the positions
+    vector<OBJHull> hulls;            //!< convex hulls when requested
+    bool query;                       //!< Load() stops before creating meshes
+    OBJMeshData* pending;             //!< mesh data waiting for LoadInto()
+    vector<unsigned int> pendingIndices; //!< triangle or strip indices waiting
+    vector<unsigned int> pendingLines;   //!< line indices waiting
+    vector<unsigned int> pendingPoints;  //!< point indices waiting
+    OBJBufferSizes sizes;             //!< sizes of the waiting data
+    OBJMemoryUsage memory;            //!< memory held by the loaded data
+    OBJLoadProfile profile;           //!< profile of the last load
+    Utils::Time lapStart;             //!< start of the phase being timed
 
     // helper methods
     void Error(int line, string msg);
+    void ReportErrors();
     void LoadMaterialFile(string file);
+    void Account();
+    void Lap(boost::uint64_t& phase);
+    void LoadDone(Utils::Time start, OBJTraceSpan& trace);
 
 public:
-    OBJResource(string file);
+    OBJResource(string file, OBJLoadOptions options = OBJLoadOptions());
     virtual ~OBJResource();
     void Load();
     void Unload();
+    void SetLoadOptions(OBJLoadOptions options);
+    OBJLoadOptions GetLoadOptions();
+    OBJLoadStatistics GetLoadStatistics();
+    const vector<OBJLoadError>& GetErrors();
     //FaceSet* GetFaceSet();
     ISceneNode* GetSceneNode();
+    const vector<OBJChunk>& GetChunks();
+    vector<MeshPtr> GetMeshes();
+    OBJAdjacencyPtr GetAdjacency();
+    Vector<3,double> GetOrigin();
+    const vector<OBJHull>& GetConvexHulls();
+    OBJBufferSizes QuerySizes();
+    bool LoadInto(const OBJBufferLayout& layout);
+    OBJMemoryUsage GetMemoryUsage();
+    OBJLoadProfile GetLoadProfile();
+    static void TrimParseBuffers();
 };
 
 /**
@@ -60,9 +346,15 @@ public:
  * @class OBJPlugin OBJResource.h "OBJResource.h"
  */
 class OBJPlugin : public IResourcePlugin<IModelResource> {
+private:
+    OBJLoadOptions options;
+
 public:
-	OBJPlugin();
+	OBJPlugin(OBJLoadOptions options = OBJLoadOptions());
     IModelResourcePtr CreateResource(string file);
+    void SetLoadOptions(OBJLoadOptions options);
+    OBJLoadOptions GetLoadOptions();
+    static OBJMemoryUsage GetMemoryUsage();
 };
 
 } // NS Resources
@@ -0,0 +1,161 @@
+// OBJ spatial triangle sorting.
+// -------------------------------------------------------------------
+// Copyright (C) 2007 OpenEngine.dk (See AUTHORS)
+//
+// This program is free software; It is covered by the GNU General
+// Public License version 2 or any later version.
+// See the GNU General Public License for more details (see LICENSE).
+//--------------------------------------------------------------------
+
+#include <Resources/OBJSpatialSort.h>
+#include <Resources/OBJMeshData.h>
+
+#include <algorithm>
+#include <cfloat>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace OpenEngine {
+namespace Resources {
+
+// minimum number of keys per radix sort chunk before we split the
+// work between threads
+static const unsigned int RADIX_CHUNK_SIZE = 16384;
+
+/**
+ * Spread the lower ten bits of v so there are two zero bits between
+ * each of them.
+ */
+static unsigned int ExpandBits(unsigned int v) {
+    v = (v * 0x00010001u) & 0xFF0000FFu;
+    v = (v * 0x00000101u) & 0x0F00F00Fu;
+    v = (v * 0x00000011u) & 0xC30C30C3u;
+    v = (v * 0x00000005u) & 0x49249249u;
+    return v;
+}
+
+/**
+ * Get the 30 bit Morton code of a point in the unit cube.
+ *
+ * @param x, y, z Coordinates in [0;1], values outside are clamped
+ * @return Interleaved bits of the coordinates quantized to 10 bits
+ */
+unsigned int OBJSpatialSort::MortonCode(float x, float y, float z) {
+    x = std::min(std::max(x * 1024.0f, 0.0f), 1023.0f);
+    y = std::min(std::max(y * 1024.0f, 0.0f), 1023.0f);
+    z = std::min(std::max(z * 1024.0f, 0.0f), 1023.0f);
+    return (ExpandBits((unsigned int)x) << 2)
+        | (ExpandBits((unsigned int)y) << 1)
+        | ExpandBits((unsigned int)z);
+}
+
+/**
+ * Stable least significant digit radix sort of key/value pairs.
+ *
+ * Each pass counts and scatters eight bits. The input is split into
+ * one chunk per thread, chunks are counted and scattered in parallel
+ * and the prefix sums are laid out digit major so the result is
+ * stable. Passes where all keys share the same digit are skipped.
+ *
+ * @param keys Keys to sort on
+ * @param values Values permuted along with the keys
+ */
+void OBJSpatialSort::RadixSort(vector<unsigned int>& keys,
+                               vector<unsigned int>& values) {
+    const unsigned int n = keys.size();
+    int chunks = 1;
+#ifdef _OPENMP
+    chunks = omp_get_max_threads();
+#endif
+    if (n / RADIX_CHUNK_SIZE < (unsigned int)chunks)
+        chunks = std::max(1u, n / RADIX_CHUNK_SIZE);
+
+    vector<unsigned int> tkeys(n), tvalues(n);
+    vector<unsigned int> counts(chunks * 256);
+    for (unsigned int shift = 0; shift < 32; shift += 8) {
+        std::fill(counts.begin(), counts.end(), 0);
+
+        #pragma omp parallel for
+        for (int c = 0; c < chunks; ++c) {
+            unsigned int* count = &counts[c * 256];
+            unsigned int end = c == chunks-1 ? n : (c+1) * (n / chunks);
+            for (unsigned int i = c * (n / chunks); i < end; ++i)
+                count[(keys[i] >> shift) & 0xFF]++;
+        }
+
+        // exclusive prefix sum, digit major and chunk minor
+        bool skip = false;
+        unsigned int sum = 0;
+        for (unsigned int d = 0; d < 256; ++d) {
+            unsigned int start = sum;
+            for (int c = 0; c < chunks; ++c) {
+                unsigned int t = counts[c * 256 + d];
+                counts[c * 256 + d] = sum;
+                sum += t;
+            }
+            if (sum - start == n) skip = true;
+        }
+        if (skip) continue;
+
+        #pragma omp parallel for
+        for (int c = 0; c < chunks; ++c) {
+            unsigned int* offset = &counts[c * 256];
+            unsigned int end = c == chunks-1 ? n : (c+1) * (n / chunks);
+            for (unsigned int i = c * (n / chunks); i < end; ++i) {
+                unsigned int o = offset[(keys[i] >> shift) & 0xFF]++;
+                tkeys[o] = keys[i];
+                tvalues[o] = values[i];
+            }
+        }
+        keys.swap(tkeys);
+        values.swap(tvalues);
+    }
+}
+
+/**
+ * Sort the triangles of an OBJ mesh along a Morton curve.
+ *
+ * The centroids are quantized inside the bounding box of the mesh,
+ * the triangles are reordered by their codes and the vertices are
+ * finally renumbered in first use order.
+ *
+ * @param data Mesh data to sort in place
+ */
+void OBJSpatialSort::Sort(OBJMeshData& data) {
+    const int tris = data.triangleCount;
+    if (tris < 2) return;
+
+    float min[3] = {  FLT_MAX,  FLT_MAX,  FLT_MAX };
+    float max[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+    for (unsigned int i = 0; i < data.vertexCount; ++i)
+        for (unsigned int j = 0; j < 3; ++j) {
+            min[j] = std::min(min[j], data.vertices[i*3+j]);
+            max[j] = std::max(max[j], data.vertices[i*3+j]);
+        }
+    float scale[3];
+    for (unsigned int j = 0; j < 3; ++j)
+        scale[j] = max[j] > min[j] ? 1.0f / (max[j] - min[j]) : 0.0f;
+
+    vector<unsigned int> codes(tris), order(tris);
+    #pragma omp parallel for
+    for (int t = 0; t < tris; ++t) {
+        float c[3];
+        for (unsigned int j = 0; j < 3; ++j) {
+            float s = data.vertices[data.indices[t*3]*3+j]
+                + data.vertices[data.indices[t*3+1]*3+j]
+                + data.vertices[data.indices[t*3+2]*3+j];
+            c[j] = (s / 3.0f - min[j]) * scale[j];
+        }
+        codes[t] = MortonCode(c[0], c[1], c[2]);
+        order[t] = t;
+    }
+    RadixSort(codes, order);
+
+    data.PermuteTriangles(order);
+    data.ReorderVertices();
+}
+
+} // NS Resources
+} // NS OpenEngine
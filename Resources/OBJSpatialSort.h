@@ -0,0 +1,42 @@
+// OBJ spatial triangle sorting.
+// -------------------------------------------------------------------
+// Copyright (C) 2007 OpenEngine.dk (See AUTHORS)
+//
+// This program is free software; It is covered by the GNU General
+// Public License version 2 or any later version.
+// See the GNU General Public License for more details (see LICENSE).
+//--------------------------------------------------------------------
+
+#ifndef _OBJ_SPATIAL_SORT_H_
+#define _OBJ_SPATIAL_SORT_H_
+
+#include <vector>
+
+namespace OpenEngine {
+namespace Resources {
+
+using namespace std;
+
+class OBJMeshData;
+
+/**
+ * Morton (Z-order) sorting of OBJ triangle data.
+ *
+ * Triangles are ordered by the Morton code of their centroid and
+ * the vertices are renumbered in first use order, so triangles that
+ * are close in space are also close in memory.
+ *
+ * @class OBJSpatialSort OBJSpatialSort.h "OBJSpatialSort.h"
+ */
+class OBJSpatialSort {
+public:
+    static void Sort(OBJMeshData& data);
+    static unsigned int MortonCode(float x, float y, float z);
+    static void RadixSort(vector<unsigned int>& keys,
+                          vector<unsigned int>& values);
+};
+
+} // NS Resources
+} // NS OpenEngine
+
+#endif // _OBJ_SPATIAL_SORT_H_
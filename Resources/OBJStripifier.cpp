@@ -0,0 +1,98 @@
+// OBJ triangle strip generation.
+// -------------------------------------------------------------------
+// Copyright (C) 2007 OpenEngine.dk (See AUTHORS)
+//
+// This program is free software; It is covered by the GNU General
+// Public License version 2 or any later version.
+// See the GNU General Public License for more details (see LICENSE).
+//--------------------------------------------------------------------
+
+#include <Resources/OBJStripifier.h>
+#include <Resources/OBJAdjacency.h>
+
+namespace OpenEngine {
+namespace Resources {
+
+const unsigned int OBJStripifier::RESTART;
+
+// stamp of triangles that belong to an emitted strip
+static const unsigned int DONE = ~0u;
+
+/**
+ * Grow a strip from a triangle.
+ *
+ * The strip starts with the corners of the start half-edge's
+ * triangle beginning at its origin, and continues across the edge
+ * between the last two strip vertices for as long as the triangle on
+ * the other side is free and shares the vertices of the edge.
+ *
+ * @param used Stamp of each triangle, set to stamp for the triangles
+ *             in the strip
+ * @param start Half-edge from the first to the second strip vertex
+ * @param stamp Stamp marking the triangles of this strip
+ * @param strip The strip vertices are appended here, unless NULL
+ * @return Number of triangles in the strip
+ */
+unsigned int OBJStripifier::Walk(const OBJAdjacency& adj, const unsigned int* indices,
+                                 vector<unsigned int>& used, unsigned int start,
+                                 unsigned int stamp, vector<unsigned int>* strip) {
+    if (strip) {
+        strip->push_back(indices[start]);
+        strip->push_back(indices[OBJAdjacency::Next(start)]);
+        strip->push_back(indices[OBJAdjacency::Prev(start)]);
+    }
+    used[OBJAdjacency::Face(start)] = stamp;
+    unsigned int length = 1;
+    for (unsigned int edge = OBJAdjacency::Next(start); ; ++length) {
+        unsigned int twin = adj.twin[edge];
+        if (twin == OBJAdjacency::NONE) break;
+        unsigned int face = OBJAdjacency::Face(twin);
+        if (used[face] == DONE || used[face] == stamp) break;
+        // the adjacency connects equal positions, the strip needs equal vertices
+        if (indices[twin] != indices[OBJAdjacency::Next(edge)] ||
+            indices[OBJAdjacency::Next(twin)] != indices[edge])
+            break;
+        if (strip) strip->push_back(indices[OBJAdjacency::Prev(twin)]);
+        used[face] = stamp;
+        // odd strip triangles are reversed, which moves the next edge
+        edge = length % 2 ? OBJAdjacency::Prev(twin) : OBJAdjacency::Next(twin);
+    }
+    return length;
+}
+
+/**
+ * Convert a triangle list into strips joined by restart indices.
+ *
+ * @param indices Triangle list, three per triangle
+ * @param triangleCount Number of triangles
+ * @param vertexCount Number of vertices, which must be below RESTART
+ * @param strip Set to the strip indices
+ * @return Number of strips
+ */
+unsigned int OBJStripifier::Stripify(const unsigned int* indices,
+                                     unsigned int triangleCount,
+                                     unsigned int vertexCount,
+                                     vector<unsigned int>& strip) {
+    OBJAdjacency adj(indices, triangleCount, NULL, vertexCount);
+    vector<unsigned int> used(triangleCount, 0);
+    unsigned int strips = 0, trial = 0;
+    strip.clear();
+    for (unsigned int t = 0; t < triangleCount; ++t) {
+        if (used[t] == DONE) continue;
+        unsigned int best = 0, bestLength = 0;
+        for (unsigned int r = 0; r < 3; ++r) {
+            unsigned int length = Walk(adj, indices, used, t*3 + r, ++trial, NULL);
+            if (length > bestLength) {
+                best = r;
+                bestLength = length;
+            }
+        }
+        if (strips > 0) strip.push_back(RESTART);
+        Walk(adj, indices, used, t*3 + best, DONE, &strip);
+        strips++;
+    }
+    return strips;
+}
+
+} // NS Resources
+} // NS OpenEngine
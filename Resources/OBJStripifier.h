@@ -0,0 +1,53 @@
+// OBJ triangle strip generation.
+// -------------------------------------------------------------------
+// Copyright (C) 2007 OpenEngine.dk (See AUTHORS)
+//
+// This program is free software; It is covered by the GNU General
+// Public License version 2 or any later version.
+// See the GNU General Public License for more details (see LICENSE).
+//--------------------------------------------------------------------
+
+#ifndef _OBJ_STRIPIFIER_H_
+#define _OBJ_STRIPIFIER_H_
+
+#include <vector>
+
+namespace OpenEngine {
+namespace Resources {
+
+using namespace std;
+
+class OBJAdjacency;
+
+/**
+ * Conversion of an indexed triangle list into triangle strips.
+ *
+ * Strips are grown greedily across shared edges found with the
+ * half-edge adjacency of the triangles. Each strip starts at the
+ * first unused triangle, in the corner order that gives the longest
+ * strip, and the strips are joined by a restart index, so the result
+ * must be drawn with primitive restart enabled. Every other triangle
+ * of a strip is reversed as usual, so the winding of the list is
+ * kept.
+ *
+ * @class OBJStripifier OBJStripifier.h "OBJStripifier.h"
+ */
+class OBJStripifier {
+private:
+    static unsigned int Walk(const OBJAdjacency& adj, const unsigned int* indices,
+                             vector<unsigned int>& used, unsigned int start,
+                             unsigned int stamp, vector<unsigned int>* strip);
+
+public:
+    static const unsigned int RESTART = 0xFFFF; //!< index separating strips
+
+    static unsigned int Stripify(const unsigned int* indices,
+                                 unsigned int triangleCount,
+                                 unsigned int vertexCount,
+                                 vector<unsigned int>& strip);
+};
+
+} // NS Resources
+} // NS OpenEngine
+
+#endif // _OBJ_STRIPIFIER_H_
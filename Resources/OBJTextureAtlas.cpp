@@ -0,0 +1,241 @@
+// OBJ texture atlas packing.
+// -------------------------------------------------------------------
+// Copyright (C) 2007 OpenEngine.dk (See AUTHORS)
+//
+// This program is free software; It is covered by the GNU General
+// Public License version 2 or any later version.
+// See the GNU General Public License for more details (see LICENSE).
+//--------------------------------------------------------------------
+
+#include <Resources/OBJTextureAtlas.h>
+#include <Resources/Texture2D.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace OpenEngine {
+namespace Resources {
+
+// pixels of repeated border around each packed texture
+static const unsigned int ATLAS_PADDING = 1;
+
+OBJSkylinePacker::OBJSkylinePacker(unsigned int width, unsigned int height)
+    : width(width), height(height) {
+    Segment s = { 0, 0, width };
+    skyline.push_back(s);
+}
+
+/**
+ * Test if a rectangle fits with its left edge at segment i.
+ *
+ * @param y Set to the lowest position the rectangle can rest at
+ */
+bool OBJSkylinePacker::Fits(unsigned int i, unsigned int w, unsigned int h, unsigned int& y) {
+    if (skyline[i].x + w > width) return false;
+    y = 0;
+    for (unsigned int left = w; left > 0; ++i) {
+        y = std::max(y, skyline[i].y);
+        if (y + h > height) return false;
+        left -= std::min(left, skyline[i].width);
+    }
+    return true;
+}
+
+/**
+ * Place a rectangle at the lowest position available, preferring the
+ * narrowest segment on ties.
+ *
+ * @return True if the rectangle was placed
+ */
+bool OBJSkylinePacker::Insert(unsigned int w, unsigned int h, unsigned int& x, unsigned int& y) {
+    unsigned int best = skyline.size(), bestY = height, bestWidth = width + 1;
+    for (unsigned int i = 0; i < skyline.size(); ++i) {
+        unsigned int sy;
+        if (Fits(i, w, h, sy) &&
+            (sy < bestY || (sy == bestY && skyline[i].width < bestWidth))) {
+            best = i;
+            bestY = sy;
+            bestWidth = skyline[i].width;
+        }
+    }
+    if (best == skyline.size()) return false;
+    x = skyline[best].x;
+    y = bestY;
+
+    // raise the skyline under the rectangle
+    Segment s = { x, y + h, w };
+    skyline.insert(skyline.begin() + best, s);
+    for (unsigned int i = best + 1; i < skyline.size(); ) {
+        unsigned int end = x + w;
+        if (skyline[i].x >= end) break;
+        unsigned int shrink = std::min(end - skyline[i].x, skyline[i].width);
+        skyline[i].x += shrink;
+        skyline[i].width -= shrink;
+        if (skyline[i].width == 0)
+            skyline.erase(skyline.begin() + i);
+        else break;
+    }
+    // merge neighbours of equal height
+    for (unsigned int i = 0; i + 1 < skyline.size(); ) {
+        if (skyline[i].y == skyline[i+1].y) {
+            skyline[i].width += skyline[i+1].width;
+            skyline.erase(skyline.begin() + i + 1);
+        } else ++i;
+    }
+    return true;
+}
+
+/**
+ * A texture waiting to be packed.
+ */
+struct AtlasItem {
+    unsigned int material;
+    ITexture2DPtr texture;
+    unsigned int width, height, channels;
+    unsigned int x, y, page;
+
+    bool operator<(const AtlasItem& other) const {
+        if (channels != other.channels) return channels < other.channels;
+        if (height != other.height) return height > other.height;
+        return width > other.width;
+    }
+};
+
+/**
+ * Test if two materials only differ by their textures.
+ */
+static bool SameStyle(MaterialPtr a, MaterialPtr b) {
+    return a->ambient == b->ambient && a->diffuse == b->diffuse &&
+        a->specular == b->specular && a->shininess == b->shininess &&
+        a->shad == b->shad;
+}
+
+/**
+ * Copy a texture into an atlas with a border of repeated edge pixels.
+ */
+static void CopyPadded(const AtlasItem& item, unsigned char* atlas, unsigned int atlasSize) {
+    const unsigned char* src = (const unsigned char*)item.texture->GetVoidDataPtr();
+    const unsigned int c = item.channels, p = ATLAS_PADDING;
+    for (unsigned int y = 0; y < item.height + 2*p; ++y) {
+        unsigned int sy = std::min(std::max(y, p) - p, item.height - 1);
+        unsigned char* dst = atlas + ((item.y + y) * atlasSize + item.x) * c;
+        for (unsigned int x = 0; x < item.width + 2*p; ++x) {
+            unsigned int sx = std::min(std::max(x, p) - p, item.width - 1);
+            memcpy(dst + x*c, src + (sy * item.width + sx) * c, c);
+        }
+    }
+}
+
+/**
+ * Pack the small diffuse maps of a set of materials into atlases.
+ *
+ * @param materials Materials to pack, collapsed materials using the
+ *                  atlases are appended
+ * @param packable Materials whose faces allow moving their texture
+ *                 coordinates into an atlas, i.e. do not tile
+ * @param atlasSize Width and height of each atlas texture
+ * @param maxTextureSize Largest width or height of a packed texture
+ * @param rects Set to the placement of each material texture
+ * @param remap Set to the material to use in place of each material
+ * @return Number of textures packed
+ */
+unsigned int OBJTextureAtlas::Pack(vector<MaterialPtr>& materials,
+                                   const vector<bool>& packable,
+                                   unsigned int atlasSize,
+                                   unsigned int maxTextureSize,
+                                   vector<OBJAtlasRect>& rects,
+                                   vector<unsigned int>& remap) {
+    const unsigned int count = materials.size();
+    OBJAtlasRect none = { false, { 0.0f, 0.0f }, { 1.0f, 1.0f } };
+    rects.assign(count, none);
+    remap.resize(count);
+    for (unsigned int i = 0; i < count; ++i)
+        remap[i] = i;
+
+    // find the materials with a single small 8 bit diffuse map
+    vector<AtlasItem> items;
+    for (unsigned int i = 0; i < count; ++i) {
+        if (!materials[i] || !packable[i]) continue;
+        list< pair<string, ITexture2DPtr> > textures = materials[i]->Get2DTextures();
+        if (textures.size() != 1 || !textures.front().second) continue;
+        AtlasItem item;
+        item.material = i;
+        item.texture = textures.front().second;
+        item.texture->Load();
+        item.width = item.texture->GetWidth();
+        item.height = item.texture->GetHeight();
+        item.channels = item.texture->GetChannels();
+        ColorFormat format = item.texture->GetColorFormat();
+        if (item.width == 0 || item.height == 0 ||
+            item.width > maxTextureSize || item.height > maxTextureSize ||
+            !item.texture->GetVoidDataPtr() || (format != RGB && format != RGBA))
+            continue;
+        items.push_back(item);
+    }
+    std::sort(items.begin(), items.end());
+
+    // fill one atlas page at a time for each channel count
+    const unsigned int pad = 2 * ATLAS_PADDING;
+    unsigned int packed = 0;
+    for (unsigned int first = 0; first < items.size(); ) {
+        unsigned int end = first;
+        while (end < items.size() && items[end].channels == items[first].channels)
+            ++end;
+        vector<bool> placed(items.size(), false);
+        unsigned int left = end - first;
+        while (left > 0) {
+            OBJSkylinePacker packer(atlasSize, atlasSize);
+            vector<unsigned int> page;
+            for (unsigned int i = first; i < end; ++i)
+                if (!placed[i] && packer.Insert(items[i].width + pad, items[i].height + pad,
+                                                items[i].x, items[i].y)) {
+                    placed[i] = true;
+                    page.push_back(i);
+                }
+            // a single texture is not worth an atlas
+            if (page.size() < 2) break;
+            left -= page.size();
+
+            const unsigned int channels = items[first].channels;
+            unsigned char* pixels = new unsigned char[atlasSize * atlasSize * channels];
+            memset(pixels, 0, atlasSize * atlasSize * channels);
+            ITexture2DPtr atlas = ITexture2DPtr(new Texture2D<unsigned char>(atlasSize, atlasSize,
+                                                                             channels, pixels));
+            vector<unsigned int> collapsed;
+            for (unsigned int k = 0; k < page.size(); ++k) {
+                const AtlasItem& item = items[page[k]];
+                CopyPadded(item, pixels, atlasSize);
+                OBJAtlasRect& rect = rects[item.material];
+                rect.packed = true;
+                rect.offset[0] = float(item.x + ATLAS_PADDING) / atlasSize;
+                rect.offset[1] = float(item.y + ATLAS_PADDING) / atlasSize;
+                rect.scale[0] = float(item.width) / atlasSize;
+                rect.scale[1] = float(item.height) / atlasSize;
+
+                // reuse a collapsed material of the same style
+                MaterialPtr m = materials[item.material];
+                unsigned int c = 0;
+                for (; c < collapsed.size(); ++c)
+                    if (SameStyle(materials[collapsed[c]], m)) break;
+                if (c == collapsed.size()) {
+                    MaterialPtr shared = MaterialPtr(new Material());
+                    shared->ambient = m->ambient;
+                    shared->diffuse = m->diffuse;
+                    shared->specular = m->specular;
+                    shared->shininess = m->shininess;
+                    shared->shad = m->shad;
+                    shared->AddTexture(atlas, "diffuseMap");
+                    collapsed.push_back(materials.size());
+                    materials.push_back(shared);
+                }
+                remap[item.material] = collapsed[c];
+                packed++;
+            }
+        }
+        first = end;
+    }
+    return packed;
+}
+
+} // NS Resources
+} // NS OpenEngine
@@ -0,0 +1,81 @@
+// OBJ texture atlas packing.
+// -------------------------------------------------------------------
+// Copyright (C) 2007 OpenEngine.dk (See AUTHORS)
+//
+// This program is free software; It is covered by the GNU General
+// Public License version 2 or any later version.
+// See the GNU General Public License for more details (see LICENSE).
+//--------------------------------------------------------------------
+
+#ifndef _OBJ_TEXTURE_ATLAS_H_
+#define _OBJ_TEXTURE_ATLAS_H_
+
+#include <Geometry/Material.h>
+
+#include <vector>
+
+namespace OpenEngine {
+namespace Resources {
+
+using namespace OpenEngine::Geometry;
+using namespace std;
+
+/**
+ * Skyline bottom-left rectangle packer.
+ *
+ * The packer keeps the top outline of the packed rectangles as a
+ * list of horizontal segments and places each new rectangle where it
+ * ends up lowest.
+ *
+ * @class OBJSkylinePacker OBJTextureAtlas.h "OBJTextureAtlas.h"
+ */
+class OBJSkylinePacker {
+private:
+    struct Segment {
+        unsigned int x, y, width;
+    };
+    unsigned int width, height;
+    vector<Segment> skyline;
+
+    bool Fits(unsigned int i, unsigned int w, unsigned int h, unsigned int& y);
+
+public:
+    OBJSkylinePacker(unsigned int width, unsigned int height);
+    bool Insert(unsigned int w, unsigned int h, unsigned int& x, unsigned int& y);
+};
+
+/**
+ * Placement of a material texture in an atlas.
+ */
+struct OBJAtlasRect {
+    bool packed;      //!< the material texture was packed
+    float offset[2];  //!< texture coordinate offset in the atlas
+    float scale[2];   //!< texture coordinate scale in the atlas
+};
+
+/**
+ * Packing of small diffuse textures into texture atlases.
+ *
+ * Materials with a small 8 bit diffuse map are packed into atlas
+ * textures. Packed materials that only differed by their texture are
+ * collapsed into one material using the atlas, and the texture
+ * coordinates of their faces must be moved into the atlas with the
+ * returned rectangles. Textures are padded by one pixel of repeated
+ * border to avoid bleeding from their neighbours when filtered.
+ *
+ * @class OBJTextureAtlas OBJTextureAtlas.h "OBJTextureAtlas.h"
+ */
+class OBJTextureAtlas {
+public:
+    static unsigned int Pack(vector<MaterialPtr>& materials,
+                             const vector<bool>& packable,
+                             unsigned int atlasSize,
+                             unsigned int maxTextureSize,
+                             vector<OBJAtlasRect>& rects,
+                             vector<unsigned int>& remap);
+};
+
+} // NS Resources
+} // NS OpenEngine
+
+#endif // _OBJ_TEXTURE_ATLAS_H_
@@ -0,0 +1,22 @@
+// OBJ loader thread local storage.
+// -------------------------------------------------------------------
+// Copyright (C) 2007 OpenEngine.dk (See AUTHORS)
+//
+// This program is free software; It is covered by the GNU General
+// Public License version 2 or any later version.
+// See the GNU General Public License for more details (see LICENSE).
+//--------------------------------------------------------------------
+
+#ifndef _OBJ_THREAD_LOCAL_H_
+#define _OBJ_THREAD_LOCAL_H_
+
+// storage class of variables with a copy per thread, the intrinsics
+// are included for the interlocked functions used with them
+#ifdef _MSC_VER
+#include <intrin.h>
+#define OBJ_THREAD_LOCAL __declspec(thread)
+#else
+#define OBJ_THREAD_LOCAL __thread
+#endif
+
+#endif // _OBJ_THREAD_LOCAL_H_
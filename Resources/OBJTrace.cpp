@@ -0,0 +1,203 @@
+// OBJ loader tracing.
+// -------------------------------------------------------------------
+// Copyright (C) 2007 OpenEngine.dk (See AUTHORS)
+//
+// This program is free software; It is covered by the GNU General
+// Public License version 2 or any later version.
+// See the GNU General Public License for more details (see LICENSE).
+//--------------------------------------------------------------------
+
+#include <Resources/OBJTrace.h>
+#include <Resources/OBJThreadLocal.h>
+#include <Utils/Timer.h>
+
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+namespace OpenEngine {
+namespace Resources {
+
+using OpenEngine::Utils::Timer;
+
+/**
+ * A begin or end event.
+ */
+struct TraceEvent {
+    char phase;           //!< 'B' or 'E'
+    const char* name;     //!< span name
+    boost::uint64_t time; //!< microseconds
+    string args;          //!< JSON members of the arguments
+};
+
+/**
+ * The events of one thread. The buffers of all threads that have
+ * traced form a list that is only ever pushed to.
+ */
+struct TraceBuffer {
+    unsigned int thread;
+    vector<TraceEvent> events;
+    TraceBuffer* next;
+};
+
+static TraceBuffer* volatile traceBuffers = NULL;
+static volatile long traceThreads = 0;
+static volatile long traceEnabled = 0;
+static string traceFile;
+
+// buffer of the calling thread, created by its first event
+static OBJ_THREAD_LOCAL TraceBuffer* threadTrace = NULL;
+
+/**
+ * Get the buffer of the calling thread, linking in a new buffer the
+ * first time.
+ */
+static TraceBuffer* ThreadBuffer() {
+    if (threadTrace) return threadTrace;
+    TraceBuffer* buffer = new TraceBuffer();
+#ifdef _MSC_VER
+    buffer->thread = _InterlockedIncrement(&traceThreads);
+    do buffer->next = traceBuffers;
+    while (_InterlockedCompareExchangePointer((void* volatile*)&traceBuffers,
+                                              buffer, buffer->next) != buffer->next);
+#else
+    buffer->thread = __sync_add_and_fetch(&traceThreads, 1);
+    do buffer->next = traceBuffers;
+    while (!__sync_bool_compare_and_swap(&traceBuffers, buffer->next, buffer));
+#endif
+    threadTrace = buffer;
+    return buffer;
+}
+
+/**
+ * Record an event in the buffer of the calling thread.
+ */
+static void Record(char phase, const char* name, const string& args) {
+    TraceEvent event;
+    event.phase = phase;
+    event.name = name;
+    event.time = Timer::GetTime().AsInt();
+    event.args = args;
+    ThreadBuffer()->events.push_back(event);
+}
+
+/**
+ * Quote a string for JSON.
+ */
+static string Quote(const string& s) {
+    string out = "\"";
+    for (unsigned int i = 0; i < s.size(); ++i) {
+        if (s[i] == '"' || s[i] == '\\') out += '\\';
+        if ((unsigned char)s[i] < 0x20) out += ' ';
+        else out += s[i];
+    }
+    return out + "\"";
+}
+
+/**
+ * Start recording events, dropping any recorded earlier.
+ *
+ * @param file Path of the JSON file written by Stop()
+ */
+void OBJTrace::Start(string file) {
+    for (TraceBuffer* b = traceBuffers; b; b = b->next)
+        b->events.clear();
+    traceFile = file;
+    traceEnabled = 1;
+}
+
+/**
+ * Stop recording and write the events to the file given to Start().
+ *
+ * @return False if the file could not be written
+ */
+bool OBJTrace::Stop() {
+    if (!traceEnabled) return false;
+    traceEnabled = 0;
+    ofstream out(traceFile.c_str());
+    out << "{\"traceEvents\":[";
+    bool first = true;
+    for (TraceBuffer* b = traceBuffers; b; b = b->next) {
+        for (unsigned int i = 0; i < b->events.size(); ++i) {
+            const TraceEvent& e = b->events[i];
+            out << (first ? "\n" : ",\n")
+                << "{\"name\":" << Quote(e.name) << ",\"cat\":\"obj\",\"ph\":\"" << e.phase
+                << "\",\"ts\":" << e.time << ",\"pid\":1,\"tid\":" << b->thread
+                << ",\"args\":{" << e.args << "}}";
+            first = false;
+        }
+        b->events.clear();
+    }
+    out << "\n]}\n";
+    return out.good();
+}
+
+/**
+ * Test if events are being recorded.
+ */
+bool OBJTrace::IsEnabled() {
+    return traceEnabled != 0;
+}
+
+/**
+ * Record the start of a span on the calling thread.
+ *
+ * @param name Span name, must stay valid until Stop()
+ * @param args JSON object members describing the span, or empty
+ */
+void OBJTrace::Begin(const char* name, const string& args) {
+    if (traceEnabled) Record('B', name, args);
+}
+
+/**
+ * Record the end of the innermost open span on the calling thread.
+ * @see Begin
+ */
+void OBJTrace::End(const char* name, const string& args) {
+    if (traceEnabled) Record('E', name, args);
+}
+
+/**
+ * Begin a span.
+ */
+OBJTraceSpan::OBJTraceSpan(const char* name)
+    : name(name), active(OBJTrace::IsEnabled()) {
+    if (active) OBJTrace::Begin(name, "");
+}
+
+/**
+ * Begin a span working on a file.
+ */
+OBJTraceSpan::OBJTraceSpan(const char* name, const string& file)
+    : name(name), active(OBJTrace::IsEnabled()) {
+    if (active) OBJTrace::Begin(name, "\"file\":" + Quote(file));
+}
+
+/**
+ * End the span if it has not been ended.
+ */
+OBJTraceSpan::~OBJTraceSpan() {
+    End();
+}
+
+/**
+ * Add a count to the arguments of the end event.
+ */
+void OBJTraceSpan::Count(const char* key, boost::uint64_t value) {
+    if (!active) return;
+    std::ostringstream s;
+    s << (args.empty() ? "" : ",") << Quote(key) << ":" << value;
+    args += s.str();
+}
+
+/**
+ * End the span.
+ */
+void OBJTraceSpan::End() {
+    if (!active) return;
+    OBJTrace::End(name, args);
+    active = false;
+}
+
+} // NS Resources
+} // NS OpenEngine
@@ -0,0 +1,68 @@
+// OBJ loader tracing.
+// -------------------------------------------------------------------
+// Copyright (C) 2007 OpenEngine.dk (See AUTHORS)
+//
+// This program is free software; It is covered by the GNU General
+// Public License version 2 or any later version.
+// See the GNU General Public License for more details (see LICENSE).
+//--------------------------------------------------------------------
+
+#ifndef _OBJ_TRACE_H_
+#define _OBJ_TRACE_H_
+
+#include <boost/cstdint.hpp>
+#include <string>
+
+namespace OpenEngine {
+namespace Resources {
+
+using namespace std;
+
+/**
+ * Trace of the work done by the OBJ loader.
+ *
+ * While tracing is on, the loader records a begin and an end event
+ * for each load, material file and pipeline stage. Stop() writes
+ * them in the Chrome trace event format, which chrome://tracing and
+ * Perfetto display on a timeline per thread.
+ *
+ * Each thread appends to its own buffer, so tracing does not make
+ * parallel loads wait for each other. The buffers are collected by
+ * Stop(), which must not be called while loads are running. When
+ * tracing is off, recording an event costs a single test.
+ *
+ * @class OBJTrace OBJTrace.h "OBJTrace.h"
+ */
+class OBJTrace {
+public:
+    static void Start(string file);
+    static bool Stop();
+    static bool IsEnabled();
+    static void Begin(const char* name, const string& args);
+    static void End(const char* name, const string& args);
+};
+
+/**
+ * A traced span, begun at construction and ended by End() or the
+ * destructor.
+ *
+ * @class OBJTraceSpan OBJTrace.h "OBJTrace.h"
+ */
+class OBJTraceSpan {
+private:
+    const char* name; //!< span name, must outlive the trace
+    bool active;      //!< span was begun and not ended yet
+    string args;      //!< arguments of the end event
+
+public:
+    OBJTraceSpan(const char* name);
+    OBJTraceSpan(const char* name, const string& file);
+    ~OBJTraceSpan();
+    void Count(const char* key, boost::uint64_t value);
+    void End();
+};
+
+} // NS Resources
+} // NS OpenEngine
+
+#endif // _OBJ_TRACE_H_
@@ -0,0 +1,153 @@
+// OBJ vertex welding.
+// -------------------------------------------------------------------
+// Copyright (C) 2007 OpenEngine.dk (See AUTHORS)
+//
+// This program is free software; It is covered by the GNU General
+// Public License version 2 or any later version.
+// See the GNU General Public License for more details (see LICENSE).
+//--------------------------------------------------------------------
+
+#include <Resources/OBJWeld.h>
+#include <Resources/OBJMeshData.h>
+
+#include <boost/cstdint.hpp>
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+namespace OpenEngine {
+namespace Resources {
+
+using namespace std;
+using boost::uint64_t;
+
+// grid cell coordinates are wrapped to 21 bits so three of them fit
+// in a 64 bit key, wrapped cells only cause extra comparisons
+static const uint64_t CELL_MASK = 0x1FFFFF;
+
+// most cells along a side of the grid, so cell coordinates and
+// their neighbours fit in an int
+static const float MAX_CELLS = 1073741824.0f; // 2^30
+
+typedef pair<uint64_t, unsigned int> CellEntry;
+
+/**
+ * Get the hash key of a grid cell.
+ */
+static uint64_t CellKey(int x, int y, int z) {
+    return ((uint64_t)x & CELL_MASK)
+        | (((uint64_t)y & CELL_MASK) << 21)
+        | (((uint64_t)z & CELL_MASK) << 42);
+}
+
+/**
+ * Test if all components of two attributes are within epsilon.
+ */
+static bool Near(const float* a, const float* b, unsigned int dim, float epsilon) {
+    for (unsigned int i = 0; i < dim; ++i)
+        if (fabs(a[i] - b[i]) > epsilon) return false;
+    return true;
+}
+
+/**
+ * Weld vertices that are equal within a tolerance.
+ *
+ * Each vertex is merged into the lowest numbered matching vertex in
+ * its neighbourhood. The matches are searched in parallel and then
+ * resolved in vertex order, so the result does not depend on the
+ * number of threads. The remaining vertices keep their relative
+ * order and the indices are updated to match.
+ *
+ * @param data Mesh data to weld in place
+ * @param epsilon Largest difference of a position component, zero
+ *                only welds exact duplicates
+ * @param normalEpsilon Largest difference of a normal component
+ * @param texcoordEpsilon Largest difference of a texture coordinate
+ *                        or colour component
+ * @return Number of vertices merged away
+ */
+unsigned int OBJWeld::Weld(OBJMeshData& data, float epsilon,
+                           float normalEpsilon, float texcoordEpsilon) {
+    const int count = data.vertexCount;
+    if (count < 2) return 0;
+
+    float min[3] = {  FLT_MAX,  FLT_MAX,  FLT_MAX };
+    float max[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+    for (int i = 0; i < count; ++i)
+        for (unsigned int j = 0; j < 3; ++j) {
+            min[j] = std::min(min[j], data.vertices[i*3+j]);
+            max[j] = std::max(max[j], data.vertices[i*3+j]);
+        }
+    // exact welding still needs a cell size, so use a fraction of
+    // the model extent, and tiny tolerances on large models get cells
+    // large enough for the coordinates to fit in an int
+    const float extent = std::max(max[0] - min[0], std::max(max[1] - min[1], max[2] - min[2]));
+    float cell = epsilon > 0.0f ? std::max(epsilon, extent / MAX_CELLS) : extent / 1024.0f;
+    if (cell <= 0.0f) cell = 1.0f;
+
+    // bucket the vertices by grid cell
+    vector<int> coords(count * 3);
+    vector<CellEntry> grid(count);
+    #pragma omp parallel for
+    for (int i = 0; i < count; ++i) {
+        for (unsigned int j = 0; j < 3; ++j)
+            coords[i*3+j] = (int)floor((data.vertices[i*3+j] - min[j]) / cell);
+        grid[i] = CellEntry(CellKey(coords[i*3], coords[i*3+1], coords[i*3+2]), i);
+    }
+    std::sort(grid.begin(), grid.end());
+
+    // find the lowest numbered match of each vertex
+    vector<unsigned int> rep(count);
+    #pragma omp parallel for
+    for (int i = 0; i < count; ++i) {
+        unsigned int best = i;
+        for (int dz = -1; dz <= 1; ++dz)
+        for (int dy = -1; dy <= 1; ++dy)
+        for (int dx = -1; dx <= 1; ++dx) {
+            uint64_t key = CellKey(coords[i*3] + dx, coords[i*3+1] + dy, coords[i*3+2] + dz);
+            vector<CellEntry>::const_iterator it =
+                std::lower_bound(grid.begin(), grid.end(), CellEntry(key, 0));
+            for (; it != grid.end() && it->first == key && it->second < best; ++it) {
+                unsigned int j = it->second;
+                if (Near(&data.vertices[i*3], &data.vertices[j*3], 3, epsilon) &&
+                    Near(&data.normals[i*3], &data.normals[j*3], 3, normalEpsilon) &&
+                    Near(&data.texcoords[i*2], &data.texcoords[j*2], 2, texcoordEpsilon) &&
+                    (!data.colors || Near(&data.colors[i*3], &data.colors[j*3], 3, texcoordEpsilon)))
+                    best = j;
+            }
+        }
+        rep[i] = best;
+    }
+
+    // resolve chains and compact the surviving vertices in place
+    unsigned int kept = 0;
+    vector<unsigned int> remap(count);
+    for (int i = 0; i < count; ++i) {
+        if (rep[i] != (unsigned int)i) {
+            remap[i] = remap[rep[i]];
+            continue;
+        }
+        remap[i] = kept;
+        for (unsigned int j = 0; j < 3; ++j) {
+            data.vertices[kept*3+j] = data.vertices[i*3+j];
+            data.normals[kept*3+j] = data.normals[i*3+j];
+            if (data.colors) data.colors[kept*3+j] = data.colors[i*3+j];
+        }
+        data.texcoords[kept*2]   = data.texcoords[i*2];
+        data.texcoords[kept*2+1] = data.texcoords[i*2+1];
+        kept++;
+    }
+
+    const int indexCount = data.triangleCount * 3;
+    #pragma omp parallel for
+    for (int i = 0; i < indexCount; ++i)
+        data.indices[i] = remap[data.indices[i]];
+
+    data.vertexCount = kept;
+    return count - kept;
+}
+
+} // NS Resources
+} // NS OpenEngine
@@ -0,0 +1,42 @@
+// OBJ vertex welding.
+// -------------------------------------------------------------------
+// Copyright (C) 2007 OpenEngine.dk (See AUTHORS)
+//
+// This program is free software; It is covered by the GNU General
+// Public License version 2 or any later version.
+// See the GNU General Public License for more details (see LICENSE).
+//--------------------------------------------------------------------
+
+#ifndef _OBJ_WELD_H_
+#define _OBJ_WELD_H_
+
+namespace OpenEngine {
+namespace Resources {
+
+class OBJMeshData;
+
+/**
+ * Welding of nearly identical vertices in OBJ triangle data.
+ *
+ * Vertices are bucketed in a spatial hash grid with cells the size
+ * of the position tolerance, so only vertices in neighbouring cells
+ * have to be compared. Two vertices are merged when every component
+ * of their positions, normals, texture coordinates and colours
+ * differs by at most the tolerance of the attribute. Positions are
+ * in model units while normals are unit vectors and texture
+ * coordinates and colours are usually in [0;1], so each has a
+ * tolerance of its own, colours sharing that of the texture
+ * coordinates.
+ *
+ * @class OBJWeld OBJWeld.h "OBJWeld.h"
+ */
+class OBJWeld {
+public:
+    static unsigned int Weld(OBJMeshData& data, float epsilon,
+                             float normalEpsilon, float texcoordEpsilon);
+};
+
+} // NS Resources
+} // NS OpenEngine
+
+#endif // _OBJ_WELD_H_
@@ -0,0 +1,64 @@
+// OBJ half-edge adjacency tests.
+// -------------------------------------------------------------------
+// Copyright (C) 2007 OpenEngine.dk (See AUTHORS)
+//
+// This program is free software; It is covered by the GNU General
+// Public License version 2 or any later version.
+// See the GNU General Public License for more details (see LICENSE).
+//--------------------------------------------------------------------
+
+#include <Resources/OBJAdjacency.h>
+
+#include <boost/test/unit_test.hpp>
+
+using namespace OpenEngine::Resources;
+
+BOOST_AUTO_TEST_SUITE(OBJAdjacencyTest)
+
+// the second triangle has its own copies of the diagonal corners, as
+// it would with other normals, and still shares the diagonal
+BOOST_AUTO_TEST_CASE(VerticesAreJoinedByPosition) {
+    const float vertices[] = { 0,0,0, 1,0,0, 1,1,0, 0,1,0, 0,0,0, 1,1,0 };
+    const unsigned int indices[] = { 0, 1, 2,  4, 5, 3 };
+    OBJAdjacency adj(indices, 2, vertices, 6);
+
+    BOOST_CHECK_EQUAL(adj.GetHalfEdgeCount(), 6u);
+    BOOST_CHECK_EQUAL(adj.GetPositionCount(), 4u);
+    BOOST_CHECK_EQUAL(adj.position[4], adj.position[0]);
+    BOOST_CHECK_EQUAL(adj.position[5], adj.position[2]);
+
+    // the diagonal runs 2->0 in the first triangle and 4->5 in the second
+    BOOST_CHECK_EQUAL(adj.twin[2], 3u);
+    BOOST_CHECK_EQUAL(adj.twin[3], 2u);
+    unsigned int boundary = 0;
+    for (unsigned int h = 0; h < 6; ++h) {
+        boundary += adj.IsBoundary(h);
+        if (!adj.IsBoundary(h)) {
+            BOOST_CHECK_EQUAL(adj.twin[adj.twin[h]], h);
+            BOOST_CHECK_EQUAL(adj.origin[adj.twin[h]], adj.origin[OBJAdjacency::Next(h)]);
+        }
+    }
+    BOOST_CHECK_EQUAL(boundary, 4u);
+
+    // every position has an outgoing half-edge starting at it
+    for (unsigned int p = 0; p < adj.GetPositionCount(); ++p)
+        BOOST_CHECK_EQUAL(adj.origin[adj.vertexEdge[p]], p);
+}
+
+BOOST_AUTO_TEST_CASE(HalfEdgeNavigation) {
+    BOOST_CHECK_EQUAL(OBJAdjacency::Next(3), 4u);
+    BOOST_CHECK_EQUAL(OBJAdjacency::Next(5), 3u);
+    BOOST_CHECK_EQUAL(OBJAdjacency::Prev(3), 5u);
+    BOOST_CHECK_EQUAL(OBJAdjacency::Prev(4), 3u);
+    BOOST_CHECK_EQUAL(OBJAdjacency::Face(5), 1u);
+}
+
+// three triangles on one edge cannot be paired up
+BOOST_AUTO_TEST_CASE(NonManifoldEdgesAreBoundaries) {
+    const unsigned int indices[] = { 0, 1, 2,  1, 0, 3,  1, 0, 4 };
+    OBJAdjacency adj(indices, 3, NULL, 5);
+    for (unsigned int h = 0; h < 9; ++h)
+        BOOST_CHECK(adj.IsBoundary(h));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,113 @@
+// OBJ allocator tests.
+// -------------------------------------------------------------------
+// Copyright (C) 2007 OpenEngine.dk (See AUTHORS)
+//
+// This program is free software; It is covered by the GNU General
+// Public License version 2 or any later version.
+// See the GNU General Public License for more details (see LICENSE).
+//--------------------------------------------------------------------
+
+#include "OBJTestFile.h"
+#include <Resources/OBJAllocator.h>
+#include <Resources/OBJResource.h>
+#include <Geometry/GeometrySet.h>
+
+#include <boost/test/unit_test.hpp>
+#include <map>
+
+using namespace OpenEngine::Resources;
+
+/**
+ * Allocator keeping track of the memory it has handed out.
+ */
+class CountingAllocator : public OBJAllocator {
+public:
+    map<void*, size_t> live;
+    unsigned int allocations;
+
+    CountingAllocator() : allocations(0) {}
+    void* Allocate(size_t bytes) {
+        void* p = ::operator new(bytes);
+        live[p] = bytes;
+        allocations++;
+        return p;
+    }
+    void Deallocate(void* p, size_t bytes) {
+        BOOST_REQUIRE(live.count(p));
+        // memory is returned with the size it was allocated with
+        BOOST_CHECK_EQUAL(live[p], bytes);
+        live.erase(p);
+        ::operator delete(p);
+    }
+};
+
+BOOST_AUTO_TEST_SUITE(OBJAllocatorTest)
+
+BOOST_AUTO_TEST_CASE(ArenaAlignsAndGrows) {
+    OBJArena arena(1024);
+    BOOST_CHECK_EQUAL(arena.GetSizeInBytes(), 0u);
+    char* a = (char*)arena.Allocate(3);
+    char* b = (char*)arena.Allocate(5);
+    BOOST_CHECK_EQUAL((size_t)a % 16, 0u);
+    BOOST_CHECK_EQUAL((size_t)b % 16, 0u);
+    BOOST_CHECK_EQUAL(b - a, 16);
+    const size_t one = arena.GetSizeInBytes();
+    BOOST_CHECK_GE(one, 1024u);
+    // a large allocation gets a block of its own
+    arena.Allocate(4096);
+    BOOST_CHECK_GE(arena.GetSizeInBytes(), one + 4096);
+}
+
+BOOST_AUTO_TEST_CASE(ArenaIsReusedAfterRelease) {
+    OBJArena arena(256);
+    OBJStlAllocator<unsigned int> alloc(&arena);
+    for (unsigned int round = 0; round < 3; ++round) {
+        {
+            vector<unsigned int, OBJStlAllocator<unsigned int> > v(alloc);
+            for (unsigned int i = 0; i < 1000; ++i)
+                v.push_back(i * round);
+            for (unsigned int i = 0; i < 1000; ++i)
+                BOOST_REQUIRE_EQUAL(v[i], i * round);
+        }
+        BOOST_CHECK_GT(arena.GetSizeInBytes(), 0u);
+        arena.Release();
+        BOOST_CHECK_EQUAL(arena.GetSizeInBytes(), 0u);
+    }
+}
+
+// the mesh arrays come from the allocator and go back to it when the
+// meshes are freed, with the same content as a heap load
+BOOST_AUTO_TEST_CASE(LoadThroughCustomAllocator) {
+    const string file = WriteTestFile("allocator.obj",
+        "v 0 0 0\nv 1 0 0\nv 0 1 0\nv 1 1 0\nvn 0 0 1\nvt 0 0\n"
+        "f 1/1/1 2/1/1 3/1/1\nf 2/1/1 4/1/1 3/1/1\n");
+    OBJResource heap(file);
+    heap.Load();
+    delete heap.GetSceneNode();
+
+    boost::shared_ptr<CountingAllocator> counting(new CountingAllocator());
+    OBJLoadOptions options;
+    options.allocator = counting;
+    options.arenaBlockSize = 4096;
+    {
+        OBJResource resource(file, options);
+        resource.Load();
+        delete resource.GetSceneNode();
+        BOOST_CHECK_GT(counting->allocations, 0u);
+        BOOST_CHECK(!counting->live.empty());
+
+        GeometrySetPtr a = heap.GetMeshes()[0]->GetGeometrySet();
+        GeometrySetPtr b = resource.GetMeshes()[0]->GetGeometrySet();
+        BOOST_REQUIRE_EQUAL(a->GetVertices()->GetSize(), b->GetVertices()->GetSize());
+        const float* va = (const float*)a->GetVertices()->GetVoidDataPtr();
+        const float* vb = (const float*)b->GetVertices()->GetVoidDataPtr();
+        for (unsigned int i = 0; i < a->GetVertices()->GetSize() * 3; ++i)
+            BOOST_CHECK_EQUAL(va[i], vb[i]);
+        BOOST_CHECK_EQUAL(heap.GetMeshes()[0]->GetIndices()->GetSize(),
+                          resource.GetMeshes()[0]->GetIndices()->GetSize());
+        resource.Unload();
+    }
+    BOOST_CHECK(counting->live.empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
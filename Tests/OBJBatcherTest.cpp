@@ -0,0 +1,112 @@
+// OBJ static batching tests.
+// -------------------------------------------------------------------
+// Copyright (C) 2007 OpenEngine.dk (See AUTHORS)
+//
+// This program is free software; It is covered by the GNU General
+// Public License version 2 or any later version.
+// See the GNU General Public License for more details (see LICENSE).
+//--------------------------------------------------------------------
+
+#include "OBJTestFile.h"
+#include <Resources/OBJBatcher.h>
+#include <Resources/OBJResource.h>
+#include <Resources/DataBlock.h>
+#include <Geometry/GeometrySet.h>
+
+#include <boost/test/unit_test.hpp>
+#include <algorithm>
+#include <cmath>
+
+using namespace OpenEngine::Resources;
+
+/**
+ * Create a triangle mesh from arrays of three vertices.
+ */
+static MeshPtr Triangle(const float* positions, const float* normals, MaterialPtr mat) {
+    float* vd = new float[9];
+    float* nd = new float[9];
+    std::copy(positions, positions + 9, vd);
+    std::copy(normals, normals + 9, nd);
+    unsigned short* id = new unsigned short[3];
+    id[0] = 0; id[1] = 1; id[2] = 2;
+    GeometrySetPtr gs = GeometrySetPtr(new GeometrySet(Float3DataBlockPtr(new DataBlock<3,float>(3, vd)),
+                                                       Float3DataBlockPtr(new DataBlock<3,float>(3, nd)),
+                                                       IDataBlockList(), IDataBlockPtr()));
+    return MeshPtr(new Mesh(IndicesPtr(new Indices(3, id)), TRIANGLES, gs, mat));
+}
+
+/**
+ * Get a scaling matrix.
+ */
+static Matrix<4,4,float> Scale(float x, float y, float z) {
+    Matrix<4,4,float> m;
+    for (unsigned int i = 0; i < 4; ++i)
+        for (unsigned int j = 0; j < 4; ++j)
+            m(i,j) = 0.0f;
+    m(0,0) = x; m(1,1) = y; m(2,2) = z; m(3,3) = 1.0f;
+    return m;
+}
+
+BOOST_AUTO_TEST_SUITE(OBJBatcherTest)
+
+// a triangle in the plane x + y = 0 scaled by two along x lies in the
+// plane x + 2y = 0, so its normal must turn to (1,2,0)/sqrt(5)
+BOOST_AUTO_TEST_CASE(NormalsStayPerpendicularUnderScaling) {
+    const float s = 1.0f / sqrt(2.0f);
+    const float positions[] = { 0,0,0, 1,-1,0, 0,0,1 };
+    const float normals[] = { s,s,0, s,s,0, s,s,0 };
+    OBJBatcher batcher;
+    batcher.Add(Triangle(positions, normals, MaterialPtr(new Material())), Scale(2.0f, 1.0f, 1.0f));
+    delete batcher.Build();
+
+    BOOST_REQUIRE_EQUAL(batcher.GetBatches().size(), 1u);
+    GeometrySetPtr gs = batcher.GetBatches()[0].mesh->GetGeometrySet();
+    const float* vd = (const float*)gs->GetVertices()->GetVoidDataPtr();
+    const float* nd = (const float*)gs->GetNormals()->GetVoidDataPtr();
+    const float l = 1.0f / sqrt(5.0f);
+    for (unsigned int v = 0; v < 3; ++v) {
+        BOOST_CHECK_CLOSE(nd[v*3], l, 1e-3);
+        BOOST_CHECK_CLOSE(nd[v*3+1], 2.0f * l, 1e-3);
+        BOOST_CHECK_SMALL(nd[v*3+2], 1e-6f);
+    }
+    // the normal is perpendicular to the transformed edge
+    const float edge[3] = { vd[3] - vd[0], vd[4] - vd[1], vd[5] - vd[2] };
+    BOOST_CHECK_SMALL(edge[0] * nd[0] + edge[1] * nd[1] + edge[2] * nd[2], 1e-5f);
+}
+
+BOOST_AUTO_TEST_CASE(EmptyMeshesAreSkipped) {
+    MaterialPtr mat = MaterialPtr(new Material());
+    GeometrySetPtr gs = GeometrySetPtr(new GeometrySet(Float3DataBlockPtr(new DataBlock<3,float>(0, new float[1])),
+                                                       Float3DataBlockPtr(), IDataBlockList(),
+                                                       IDataBlockPtr()));
+    OBJBatcher batcher;
+    batcher.Add(MeshPtr(new Mesh(IndicesPtr(new Indices(0, new unsigned short[1])), TRIANGLES, gs, mat)),
+                Scale(1.0f, 1.0f, 1.0f));
+    delete batcher.Build();
+    BOOST_CHECK(batcher.GetBatches().empty());
+}
+
+// the recentered positions are moved back by the origin before the
+// batch transformation
+BOOST_AUTO_TEST_CASE(RecenteredResourceKeepsItsPlace) {
+    OBJLoadOptions options;
+    options.recenter = true;
+    OBJResource resource(WriteTestFile("batch_recenter.obj",
+        "v 1000 2000 3000\nv 1004 2000 3000\nv 1000 2002 3000\nf 1 2 3\n"), options);
+    resource.Load();
+    delete resource.GetSceneNode();
+    BOOST_REQUIRE_NE(resource.GetOrigin()[0], 0.0);
+
+    OBJBatcher batcher;
+    batcher.Add(resource, Scale(2.0f, 1.0f, 1.0f));
+    delete batcher.Build();
+    BOOST_REQUIRE_EQUAL(batcher.GetBatches().size(), 1u);
+    GeometrySetPtr gs = batcher.GetBatches()[0].mesh->GetGeometrySet();
+    BOOST_REQUIRE_EQUAL(gs->GetVertices()->GetSize(), 3u);
+    const float* vd = (const float*)gs->GetVertices()->GetVoidDataPtr();
+    const float expected[] = { 2000,2000,3000, 2008,2000,3000, 2000,2002,3000 };
+    for (unsigned int i = 0; i < 9; ++i)
+        BOOST_CHECK_CLOSE(vd[i], expected[i], 1e-4);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
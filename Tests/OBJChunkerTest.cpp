@@ -0,0 +1,90 @@
+// OBJ spatial chunking tests.
+// -------------------------------------------------------------------
+// Copyright (C) 2007 OpenEngine.dk (See AUTHORS)
+//
+// This program is free software; It is covered by the GNU General
+// Public License version 2 or any later version.
+// See the GNU General Public License for more details (see LICENSE).
+//--------------------------------------------------------------------
+
+#include <Resources/OBJChunker.h>
+#include <Resources/OBJMeshData.h>
+#include <Geometry/GeometrySet.h>
+
+#include <boost/test/unit_test.hpp>
+
+using namespace OpenEngine::Resources;
+
+/**
+ * Check that every chunk fits the triangle limit and 16 bit indices,
+ * and that the chunks hold all the triangles.
+ */
+static void CheckChunks(const vector<OBJChunk>& chunks, unsigned int maxTriangles,
+                        unsigned int triangles) {
+    unsigned int total = 0;
+    for (unsigned int c = 0; c < chunks.size(); ++c) {
+        IndicesPtr is = chunks[c].mesh->GetIndices();
+        const unsigned int vertices = chunks[c].mesh->GetGeometrySet()->GetVertices()->GetSize();
+        BOOST_CHECK(is->GetSize() <= maxTriangles * 3);
+        BOOST_CHECK(vertices <= 0x10000);
+        for (unsigned int i = 0; i < is->GetSize(); ++i)
+            BOOST_REQUIRE(is->GetData()[i] < vertices);
+        total += is->GetSize() / 3;
+    }
+    BOOST_CHECK_EQUAL(total, triangles);
+}
+
+BOOST_AUTO_TEST_SUITE(OBJChunkerTest)
+
+// triangles of their own vertices around the same centroid cannot be
+// split by octant, and together have more vertices than 16 bits hold
+BOOST_AUTO_TEST_CASE(SameCentroidIsSplitByCount) {
+    const unsigned int count = 30000;
+    OBJMeshData data(count * 3, count);
+    for (unsigned int t = 0; t < count; ++t) {
+        const float v[9] = { float(t), 1.0f, 0.0f, -float(t), -1.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+        std::copy(v, v + 9, data.vertices + t*9);
+        for (unsigned int k = 0; k < 3; ++k)
+            data.indices[t*3+k] = t*3 + k;
+        data.materials[t] = 0;
+    }
+    std::fill(data.normals, data.normals + count*9, 0.0f);
+    std::fill(data.texcoords, data.texcoords + count*6, 0.0f);
+
+    vector<MaterialPtr> materials(1, MaterialPtr(new Material()));
+    vector<OBJChunk> chunks;
+    ISceneNode* node = OBJChunker::Build(data, materials, 100000, 8, chunks);
+    BOOST_CHECK(chunks.size() > 1);
+    CheckChunks(chunks, 0xFFFF / 3, count);
+    delete node;
+}
+
+// leaves at the depth limit are split further by count
+BOOST_AUTO_TEST_CASE(DepthLimitKeepsTriangleLimit) {
+    const unsigned int size = 40, count = (size-1) * (size-1) * 2;
+    OBJMeshData data(size * size, count);
+    for (unsigned int i = 0; i < size * size; ++i) {
+        data.vertices[i*3] = float(i % size);
+        data.vertices[i*3+1] = 0.0f;
+        data.vertices[i*3+2] = float(i / size);
+    }
+    std::fill(data.normals, data.normals + size*size*3, 0.0f);
+    std::fill(data.texcoords, data.texcoords + size*size*2, 0.0f);
+    unsigned int t = 0;
+    for (unsigned int y = 0; y + 1 < size; ++y)
+        for (unsigned int x = 0; x + 1 < size; ++x) {
+            const unsigned int q = y*size + x;
+            const unsigned int tris[6] = { q, q + size, q + size + 1, q, q + size + 1, q + 1 };
+            std::copy(tris, tris + 6, data.indices + t*3);
+            data.materials[t] = data.materials[t+1] = 0;
+            t += 2;
+        }
+
+    vector<MaterialPtr> materials(1, MaterialPtr(new Material()));
+    vector<OBJChunk> chunks;
+    ISceneNode* node = OBJChunker::Build(data, materials, 50, 1, chunks);
+    CheckChunks(chunks, 50, count);
+    delete node;
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,67 @@
+// OBJ vertex colour tests.
+// -------------------------------------------------------------------
+// Copyright (C) 2007 OpenEngine.dk (See AUTHORS)
+//
+// This program is free software; It is covered by the GNU General
+// Public License version 2 or any later version.
+// See the GNU General Public License for more details (see LICENSE).
+//--------------------------------------------------------------------
+
+#include "OBJTestFile.h"
+#include <Resources/OBJResource.h>
+#include <Geometry/GeometrySet.h>
+
+#include <boost/test/unit_test.hpp>
+
+using namespace OpenEngine::Resources;
+
+// a triangle with six component vertices, the last without a colour
+static const char* COLORED =
+    "v 0 0 0 1 0 0\nv 1 0 0 0 1 0\nv 0 1 0\nf 1 2 3\n";
+
+/**
+ * Get the colour block of the single mesh of a file.
+ */
+static IDataBlockPtr LoadColors(string file, bool quantize) {
+    OBJLoadOptions options;
+    options.quantizeColors = quantize;
+    OBJResource resource(file, options);
+    resource.Load();
+    delete resource.GetSceneNode();
+    BOOST_CHECK(resource.GetErrors().empty());
+    vector<MeshPtr> meshes = resource.GetMeshes();
+    BOOST_REQUIRE_EQUAL(meshes.size(), 1u);
+    BOOST_REQUIRE_EQUAL(meshes[0]->GetIndices()->GetSize(), 3u);
+    return meshes[0]->GetGeometrySet()->GetColors();
+}
+
+BOOST_AUTO_TEST_SUITE(OBJColorTest)
+
+BOOST_AUTO_TEST_CASE(MeshColors) {
+    IDataBlockPtr colors = LoadColors(WriteTestFile("colors.obj", COLORED), false);
+    BOOST_REQUIRE(colors);
+    BOOST_REQUIRE_EQUAL(colors->GetDimension(), 3u);
+    BOOST_REQUIRE_EQUAL(colors->GetSize(), 3u);
+    const float* cd = (const float*)colors->GetVoidDataPtr();
+    const float expected[] = { 1,0,0, 0,1,0, 1,1,1 };
+    for (unsigned int i = 0; i < 9; ++i)
+        BOOST_CHECK_EQUAL(cd[i], expected[i]);
+}
+
+BOOST_AUTO_TEST_CASE(QuantizedMeshColors) {
+    IDataBlockPtr colors = LoadColors(WriteTestFile("colors_bytes.obj", COLORED), true);
+    BOOST_REQUIRE(colors);
+    BOOST_REQUIRE_EQUAL(colors->GetDimension(), 4u);
+    BOOST_REQUIRE_EQUAL(colors->GetSize(), 3u);
+    const unsigned char* cd = (const unsigned char*)colors->GetVoidDataPtr();
+    const unsigned char expected[] = { 255,0,0,255, 0,255,0,255, 255,255,255,255 };
+    for (unsigned int i = 0; i < 12; ++i)
+        BOOST_CHECK_EQUAL(int(cd[i]), int(expected[i]));
+}
+
+BOOST_AUTO_TEST_CASE(UncoloredMeshHasNoColors) {
+    BOOST_CHECK(!LoadColors(WriteTestFile("colors_none.obj",
+        "v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 3\n"), false));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,81 @@
+// OBJ coordinate conversion tests.
+// -------------------------------------------------------------------
+// Copyright (C) 2007 OpenEngine.dk (See AUTHORS)
+//
+// This program is free software; It is covered by the GNU General
+// Public License version 2 or any later version.
+// See the GNU General Public License for more details (see LICENSE).
+//--------------------------------------------------------------------
+
+#include <Resources/OBJConversion.h>
+
+#include <boost/test/unit_test.hpp>
+
+using namespace OpenEngine::Resources;
+using OpenEngine::Math::Matrix;
+
+/**
+ * Get a matrix scaling each axis.
+ */
+static Matrix<4,4,float> Scaling(float x, float y, float z) {
+    Matrix<4,4,float> m;
+    m(0,0) = x;
+    m(1,1) = y;
+    m(2,2) = z;
+    return m;
+}
+
+BOOST_AUTO_TEST_SUITE(OBJConversionTest)
+
+BOOST_AUTO_TEST_CASE(IdentityLeavesDataAlone) {
+    const OBJConversion conversion(Matrix<4,4,float>(), 1.0f, false);
+    BOOST_CHECK(conversion.IsIdentity());
+    BOOST_CHECK(!OBJConversion(Matrix<4,4,float>(), 2.0f, false).IsIdentity());
+    BOOST_CHECK(!OBJConversion(Matrix<4,4,float>(), 1.0f, true).IsIdentity());
+}
+
+// the normal of the plane x + y = 0 must stay perpendicular to it
+// when x is stretched
+BOOST_AUTO_TEST_CASE(NonUniformScaleKeepsNormalsPerpendicular) {
+    const OBJConversion conversion(Scaling(2, 1, 1), 1.0f, false);
+    double tangent[3] = { 1, -1, 0 };
+    float normal[3] = { 1, 1, 0 };
+    conversion.Position(tangent);
+    conversion.Normal(normal);
+    BOOST_CHECK_EQUAL(tangent[0], 2.0);
+    BOOST_CHECK_SMALL(tangent[0] * normal[0] + tangent[1] * normal[1] + tangent[2] * normal[2], 1e-6);
+    BOOST_CHECK_GT(normal[0], 0.0f);
+    BOOST_CHECK_GT(normal[1], 0.0f);
+}
+
+// mirroring must not turn the normals inside out
+BOOST_AUTO_TEST_CASE(MirrorKeepsNormalsOutward) {
+    const OBJConversion conversion(Scaling(-1, 1, 1), 1.0f, false);
+    double p[3] = { 1, 0, 0 };
+    float n[3] = { 1, 0, 0 };
+    conversion.Position(p);
+    conversion.Normal(n);
+    BOOST_CHECK_EQUAL(p[0], -1.0);
+    BOOST_CHECK_LT(n[0], 0.0f);
+    BOOST_CHECK_EQUAL(n[1], 0.0f);
+    BOOST_CHECK_EQUAL(n[2], 0.0f);
+}
+
+BOOST_AUTO_TEST_CASE(SwapScaleAndTranslate) {
+    Matrix<4,4,float> transform;
+    transform(0,3) = 10.0f;
+    const OBJConversion conversion(transform, 3.0f, true);
+    double p[3] = { 1, 2, 4 };
+    float n[3] = { 0, 1, 0 };
+    conversion.Position(p);
+    conversion.Normal(n);
+    BOOST_CHECK_EQUAL(p[0], 13.0);
+    BOOST_CHECK_EQUAL(p[1], 12.0);
+    BOOST_CHECK_EQUAL(p[2], 6.0);
+    // normals follow the swap and ignore the translation
+    BOOST_CHECK_EQUAL(n[0], 0.0f);
+    BOOST_CHECK_EQUAL(n[1], 0.0f);
+    BOOST_CHECK_GT(n[2], 0.0f);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
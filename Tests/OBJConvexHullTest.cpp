@@ -0,0 +1,136 @@
+// OBJ convex hull tests.
+// -------------------------------------------------------------------
+// Copyright (C) 2007 OpenEngine.dk (See AUTHORS)
+//
+// This program is free software; It is covered by the GNU General
+// Public License version 2 or any later version.
+// See the GNU General Public License for more details (see LICENSE).
+//--------------------------------------------------------------------
+
+#include <Resources/OBJConvexHull.h>
+#include <Resources/OBJMeshData.h>
+
+#include <boost/test/unit_test.hpp>
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <utility>
+
+using namespace OpenEngine::Resources;
+
+/**
+ * Check that a hull is closed, with each edge used once in each
+ * direction, and that no point lies outside any of its triangles.
+ */
+static void CheckHull(const vector<float>& points, const OBJHull& hull) {
+    std::map<std::pair<unsigned int, unsigned int>, unsigned int> edges;
+    for (unsigned int i = 0; i < hull.indices.size(); i += 3)
+        for (unsigned int e = 0; e < 3; ++e)
+            edges[std::make_pair(hull.indices[i+e], hull.indices[i+(e+1)%3])]++;
+    std::map<std::pair<unsigned int, unsigned int>, unsigned int>::iterator e;
+    for (e = edges.begin(); e != edges.end(); ++e) {
+        BOOST_CHECK_EQUAL(e->second, 1u);
+        BOOST_CHECK_EQUAL(edges[std::make_pair(e->first.second, e->first.first)], 1u);
+    }
+
+    for (unsigned int i = 0; i < hull.indices.size(); i += 3) {
+        const float* a = &hull.vertices[hull.indices[i]*3];
+        const float* b = &hull.vertices[hull.indices[i+1]*3];
+        const float* c = &hull.vertices[hull.indices[i+2]*3];
+        double ab[3], ac[3], n[3];
+        for (unsigned int j = 0; j < 3; ++j) {
+            ab[j] = b[j] - a[j];
+            ac[j] = c[j] - a[j];
+        }
+        n[0] = ab[1]*ac[2] - ab[2]*ac[1];
+        n[1] = ab[2]*ac[0] - ab[0]*ac[2];
+        n[2] = ab[0]*ac[1] - ab[1]*ac[0];
+        const double length = sqrt(n[0]*n[0] + n[1]*n[1] + n[2]*n[2]);
+        BOOST_REQUIRE_GT(length, 0.0);
+        for (unsigned int p = 0; p < points.size(); p += 3) {
+            double d = 0.0;
+            for (unsigned int j = 0; j < 3; ++j)
+                d += (points[p+j] - a[j]) * n[j];
+            BOOST_CHECK_LE(d / length, 1e-5);
+        }
+    }
+}
+
+/**
+ * Get a pseudo random number in [-1;1].
+ */
+static float Random(unsigned int& seed) {
+    seed = seed * 1103515245u + 12345u;
+    return float((seed >> 8) & 0xFFFF) / 32767.5f - 1.0f;
+}
+
+BOOST_AUTO_TEST_SUITE(OBJConvexHullTest)
+
+BOOST_AUTO_TEST_CASE(CubeWithInteriorPoints) {
+    vector<float> points;
+    unsigned int seed = 1;
+    for (unsigned int i = 0; i < 100 * 3; ++i)
+        points.push_back(Random(seed) * 0.9f);
+    for (unsigned int i = 0; i < 8; ++i) {
+        points.push_back(i & 1 ? 1.0f : -1.0f);
+        points.push_back(i & 2 ? 1.0f : -1.0f);
+        points.push_back(i & 4 ? 1.0f : -1.0f);
+    }
+    OBJHull hull;
+    BOOST_REQUIRE(OBJConvexHull::Compute(&points[0], points.size() / 3, hull));
+    BOOST_CHECK_EQUAL(hull.vertices.size(), 8u * 3);
+    BOOST_CHECK_EQUAL(hull.indices.size(), 12u * 3);
+    for (unsigned int i = 0; i < hull.vertices.size(); ++i)
+        BOOST_CHECK_EQUAL(fabs(hull.vertices[i]), 1.0f);
+    CheckHull(points, hull);
+}
+
+// far from the origin, so the tolerance must follow the object size
+BOOST_AUTO_TEST_CASE(PointsOnASphere) {
+    vector<float> points;
+    unsigned int seed = 7;
+    for (unsigned int i = 0; i < 500; ++i) {
+        float p[3] = { Random(seed), Random(seed), Random(seed) };
+        float length = sqrt(p[0]*p[0] + p[1]*p[1] + p[2]*p[2]);
+        if (length < 0.1f) continue;
+        points.push_back(1000.0f + p[0] / length);
+        points.push_back(-2000.0f + p[1] / length);
+        points.push_back(p[2] / length);
+    }
+    OBJHull hull;
+    BOOST_REQUIRE(OBJConvexHull::Compute(&points[0], points.size() / 3, hull));
+    const unsigned int v = hull.vertices.size() / 3, f = hull.indices.size() / 3;
+    // a closed triangle mesh of genus zero has 2V - 4 faces
+    BOOST_CHECK_EQUAL(f, 2 * v - 4);
+    CheckHull(points, hull);
+}
+
+BOOST_AUTO_TEST_CASE(FlatPointsHaveNoHull) {
+    const float flat[] = { 0,0,0, 1,0,0, 0,1,0, 1,1,0, 0.5f,0.5f,0 };
+    const float line[] = { 0,0,0, 1,1,1, 2,2,2, 3,3,3 };
+    OBJHull hull;
+    BOOST_CHECK(!OBJConvexHull::Compute(flat, 5, hull));
+    BOOST_CHECK(!OBJConvexHull::Compute(line, 4, hull));
+    BOOST_CHECK(!OBJConvexHull::Compute(flat, 3, hull));
+    BOOST_CHECK(hull.indices.empty());
+}
+
+// the flat first object gets no hull, the tetrahedron does
+BOOST_AUTO_TEST_CASE(BuildSkipsFlatObjects) {
+    const float vertices[] = { 0,0,0, 1,0,0, 0,1,0,  0,0,0, 1,0,0, 0,1,0, 0,0,1 };
+    const unsigned int indices[] = { 0,1,2,  3,5,4, 3,4,6, 4,5,6, 5,3,6 };
+    OBJMeshData data(7, 5);
+    std::copy(vertices, vertices + 21, data.vertices);
+    std::copy(indices, indices + 15, data.indices);
+    vector<unsigned int> objects;
+    objects.push_back(0);
+    objects.push_back(1);
+    vector<OBJHull> hulls;
+    OBJConvexHull::Build(data, objects, hulls);
+    BOOST_REQUIRE_EQUAL(hulls.size(), 1u);
+    BOOST_CHECK_EQUAL(hulls[0].object, 1u);
+    BOOST_CHECK_EQUAL(hulls[0].indices.size(), 12u);
+    CheckHull(vector<float>(vertices + 9, vertices + 21), hulls[0]);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
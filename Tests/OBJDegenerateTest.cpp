@@ -0,0 +1,59 @@
+// OBJ degenerate and duplicate triangle tests.
+// -------------------------------------------------------------------
+// Copyright (C) 2007 OpenEngine.dk (See AUTHORS)
+//
+// This program is free software; It is covered by the GNU General
+// Public License version 2 or any later version.
+// See the GNU General Public License for more details (see LICENSE).
+//--------------------------------------------------------------------
+
+#include "OBJTestFile.h"
+#include <Resources/OBJResource.h>
+
+#include <boost/test/unit_test.hpp>
+
+using namespace OpenEngine::Resources;
+
+static const char* FACES =
+    "v 0 0 0\nv 1 0 0\nv 0 1 0\nv 2 0 0\nv 1 1 0\n"
+    "f 1 2 3\n"     // kept
+    "f 2 3 1\n"     // the first rotated, a duplicate
+    "f 1 3 2\n"     // opposite winding, kept
+    "f 1 1 2\n"     // collapsed corner
+    "f 1 2 4\n"     // on a line, no area
+    "f 2 5 3\n";    // kept
+
+BOOST_AUTO_TEST_SUITE(OBJDegenerateTest)
+
+BOOST_AUTO_TEST_CASE(DegenerateAndDuplicateAreDropped) {
+    OBJLoadOptions options;
+    options.removeDegenerate = true;
+    OBJResource resource(WriteTestFile("degenerate.obj", FACES), options);
+    resource.Load();
+    delete resource.GetSceneNode();
+
+    BOOST_CHECK_EQUAL(resource.GetLoadStatistics().degenerateTriangles, 2u);
+    BOOST_CHECK_EQUAL(resource.GetLoadStatistics().duplicateTriangles, 1u);
+    BOOST_REQUIRE_EQUAL(resource.GetMeshes().size(), 1u);
+    IndicesPtr is = resource.GetMeshes()[0]->GetIndices();
+    BOOST_REQUIRE_EQUAL(is->GetSize(), 9u);
+    // the kept faces are the first, the opposite winding and the last
+    const unsigned short* id = (const unsigned short*)is->GetVoidDataPtr();
+    BOOST_CHECK_EQUAL(id[1], id[5]);
+    BOOST_CHECK_EQUAL(id[2], id[4]);
+    BOOST_CHECK_NE(id[7], id[1]);
+    BOOST_CHECK_NE(id[7], id[2]);
+}
+
+BOOST_AUTO_TEST_CASE(EverythingIsKeptByDefault) {
+    OBJResource resource(WriteTestFile("degenerate_kept.obj", FACES));
+    resource.Load();
+    delete resource.GetSceneNode();
+
+    BOOST_CHECK_EQUAL(resource.GetLoadStatistics().degenerateTriangles, 0u);
+    BOOST_CHECK_EQUAL(resource.GetLoadStatistics().duplicateTriangles, 0u);
+    BOOST_REQUIRE_EQUAL(resource.GetMeshes().size(), 1u);
+    BOOST_CHECK_EQUAL(resource.GetMeshes()[0]->GetIndices()->GetSize(), 18u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,81 @@
+// OBJ line and point element tests.
+// -------------------------------------------------------------------
+// Copyright (C) 2007 OpenEngine.dk (See AUTHORS)
+//
+// This program is free software; It is covered by the GNU General
+// Public License version 2 or any later version.
+// See the GNU General Public License for more details (see LICENSE).
+//--------------------------------------------------------------------
+
+#include "OBJTestFile.h"
+#include <Resources/OBJResource.h>
+#include <Geometry/GeometrySet.h>
+
+#include <boost/test/unit_test.hpp>
+#include <sstream>
+
+using namespace OpenEngine::Resources;
+
+BOOST_AUTO_TEST_SUITE(OBJElementTest)
+
+// records longer than the old 255 character line buffer made the
+// reader spin forever
+BOOST_AUTO_TEST_CASE(LongRecordsAreReadWhole) {
+    const unsigned int count = 100;
+    std::ostringstream text, mtl;
+    mtl << "# " << string(1000, 'x') << "\nnewmtl red\nKd 1 0 0\n";
+    WriteTestFile("elements_long.mtl", mtl.str());
+    text << "mtllib elements_long.mtl\n# " << string(1000, 'x') << "\n";
+    for (unsigned int i = 0; i < count; ++i)
+        text << "v " << i << " 0 0\n";
+    text << "usemtl red\nl";
+    for (unsigned int i = 1; i <= count; ++i)
+        text << " " << i;
+    text << "\nf 1 2 3\n";
+    OBJResource resource(WriteTestFile("elements_long.obj", text.str()));
+    resource.Load();
+
+    BOOST_CHECK(resource.GetErrors().empty());
+    vector<MeshPtr> meshes = resource.GetMeshes();
+    BOOST_REQUIRE_EQUAL(meshes.size(), 2u);
+    BOOST_CHECK_EQUAL(meshes[0]->GetIndices()->GetSize(), 3u);
+    BOOST_CHECK_EQUAL(meshes[1]->GetType(), LINES);
+    BOOST_CHECK_EQUAL(meshes[1]->GetIndices()->GetSize(), (count - 1) * 2);
+    BOOST_CHECK_EQUAL(meshes[1]->GetMaterial()->diffuse[0], 1.0f);
+    delete resource.GetSceneNode();
+}
+
+// the element vertices do not fit 16 bit indices, so the elements are
+// split instead of getting truncated indices
+BOOST_AUTO_TEST_CASE(WideElementsAreSplit) {
+    const unsigned int count = 0x10000 + 100;
+    std::ostringstream text;
+    for (unsigned int i = 0; i < count; ++i)
+        text << "v " << i << " 1 2\n";
+    for (unsigned int i = 1; i <= count; ++i)
+        text << "p " << i << "\n";
+    OBJResource resource(WriteTestFile("elements_wide.obj", text.str()));
+    resource.Load();
+
+    vector<MeshPtr> meshes = resource.GetMeshes();
+    BOOST_REQUIRE_GT(meshes.size(), 1u);
+    unsigned int points = 0;
+    for (unsigned int i = 0; i < meshes.size(); ++i) {
+        BOOST_CHECK_EQUAL(meshes[i]->GetType(), POINTS);
+        IndicesPtr is = meshes[i]->GetIndices();
+        IDataBlockPtr vertices = meshes[i]->GetGeometrySet()->GetVertices();
+        BOOST_CHECK_LE(vertices->GetSize(), 0xFFFFu);
+        const unsigned short* id = (const unsigned short*)is->GetVoidDataPtr();
+        const float* vd = (const float*)vertices->GetVoidDataPtr();
+        for (unsigned int j = 0; j < is->GetSize(); ++j) {
+            BOOST_REQUIRE_LT(id[j], vertices->GetSize());
+            // the points keep their file order across the pieces
+            BOOST_REQUIRE_EQUAL(vd[id[j]*3], float(points + j));
+        }
+        points += is->GetSize();
+    }
+    BOOST_CHECK_EQUAL(points, count);
+    delete resource.GetSceneNode();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,66 @@
+// OBJ load error tests.
+// -------------------------------------------------------------------
+// Copyright (C) 2007 OpenEngine.dk (See AUTHORS)
+//
+// This program is free software; It is covered by the GNU General
+// Public License version 2 or any later version.
+// See the GNU General Public License for more details (see LICENSE).
+//--------------------------------------------------------------------
+
+#include "OBJTestFile.h"
+#include <Resources/OBJResource.h>
+
+#include <boost/test/unit_test.hpp>
+
+using namespace OpenEngine::Resources;
+
+BOOST_AUTO_TEST_SUITE(OBJErrorTest)
+
+BOOST_AUTO_TEST_CASE(ErrorsAreCountedPerKind) {
+    WriteTestFile("errors.mtl", "newmtl\n");
+    const string file = WriteTestFile("errors.obj",
+        "mtllib errors.mtl\n"           // 1
+        "v 1\n"                         // 2
+        "v 0 0 0\nv 1 0 0\nv 0 1 0\n"   // 3-5
+        "v 2\n"                         // 6
+        "f 1 2 3 4\n"                   // 7
+        "v 3\n"                         // 8
+        "f 1 2 3\n");                   // 9
+    OBJLoadOptions options;
+    options.errorLines = 2;
+    OBJResource resource(file, options);
+    resource.Load();
+    delete resource.GetSceneNode();
+
+    const vector<OBJLoadError>& errors = resource.GetErrors();
+    BOOST_REQUIRE_EQUAL(errors.size(), 3u);
+    // in the order they were first found, the material file first
+    BOOST_CHECK_EQUAL(errors[0].file, "errors.mtl");
+    BOOST_CHECK_EQUAL(errors[0].count, 1u);
+    BOOST_CHECK_EQUAL(errors[1].file, file);
+    BOOST_CHECK_EQUAL(errors[1].message, "Invalid vertex");
+    BOOST_CHECK_EQUAL(errors[1].count, 3u);
+    // only the first lines are kept
+    BOOST_REQUIRE_EQUAL(errors[1].lines.size(), 2u);
+    BOOST_CHECK_EQUAL(errors[1].lines[0], 2u);
+    BOOST_CHECK_EQUAL(errors[1].lines[1], 6u);
+    BOOST_CHECK_EQUAL(errors[2].count, 1u);
+    BOOST_REQUIRE_EQUAL(errors[2].lines.size(), 1u);
+    BOOST_CHECK_EQUAL(errors[2].lines[0], 7u);
+
+    // a new load starts over
+    resource.Unload();
+    resource.Load();
+    delete resource.GetSceneNode();
+    BOOST_REQUIRE_EQUAL(resource.GetErrors().size(), 3u);
+    BOOST_CHECK_EQUAL(resource.GetErrors()[1].count, 3u);
+}
+
+BOOST_AUTO_TEST_CASE(CleanFileHasNoErrors) {
+    OBJResource resource(WriteTestFile("errors_none.obj", "v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 3\n"));
+    resource.Load();
+    delete resource.GetSceneNode();
+    BOOST_CHECK(resource.GetErrors().empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
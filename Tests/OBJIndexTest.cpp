@@ -0,0 +1,84 @@
+// OBJ face index tests.
+// -------------------------------------------------------------------
+// Copyright (C) 2007 OpenEngine.dk (See AUTHORS)
+//
+// This program is free software; It is covered by the GNU General
+// Public License version 2 or any later version.
+// See the GNU General Public License for more details (see LICENSE).
+//--------------------------------------------------------------------
+
+#include "OBJTestFile.h"
+#include <Resources/OBJResource.h>
+#include <Resources/OBJChunker.h>
+#include <Geometry/GeometrySet.h>
+
+#include <boost/test/unit_test.hpp>
+#include <sstream>
+
+using namespace OpenEngine::Resources;
+
+BOOST_AUTO_TEST_SUITE(OBJIndexTest)
+
+BOOST_AUTO_TEST_CASE(OutOfRangeFacesAreErrors) {
+    OBJResource resource(WriteTestFile("index_range.obj",
+        "v 0 0 0\nv 1 0 0\nv 0 1 0\nvn 0 0 1\n"
+        "f 1 2 3\nf 1 2 4\nf 0 1 2\nf 1//1 2//2 3//1\nf -1 -2 -3\n"));
+    resource.Load();
+    BOOST_REQUIRE_EQUAL(resource.GetErrors().size(), 1u);
+    BOOST_CHECK_EQUAL(resource.GetErrors()[0].count, 4u);
+    BOOST_REQUIRE_EQUAL(resource.GetMeshes().size(), 1u);
+    BOOST_CHECK_EQUAL(resource.GetMeshes()[0]->GetIndices()->GetSize(), 3u);
+    delete resource.GetSceneNode();
+}
+
+BOOST_AUTO_TEST_CASE(TextureOnlyCorners) {
+    OBJResource resource(WriteTestFile("index_v_vt.obj",
+        "v 0 0 0\nv 1 0 0\nv 0 1 0\nvt 0 0\nvt 0.5 0\nvt 0 0.5\n"
+        "f 1/1 2/2 3/3\nf 1/3 3/2 2/1\n"));
+    resource.Load();
+    BOOST_CHECK(resource.GetErrors().empty());
+    BOOST_REQUIRE_EQUAL(resource.GetMeshes().size(), 1u);
+    MeshPtr mesh = resource.GetMeshes()[0];
+    BOOST_REQUIRE_EQUAL(mesh->GetIndices()->GetSize(), 6u);
+    const unsigned short* id = (const unsigned short*)mesh->GetIndices()->GetVoidDataPtr();
+    const float* vd = (const float*)mesh->GetGeometrySet()->GetVertices()->GetVoidDataPtr();
+    const float* td = (const float*)mesh->GetGeometrySet()->GetTexCoords().front()->GetVoidDataPtr();
+    // the second face pairs the positions with other coordinates
+    const float expected[6][3] = { {0,0,0}, {1,0,0.5f}, {0,1,0.5f}, {0,0,0.5f}, {0,1,0.5f}, {1,0,0} };
+    for (unsigned int i = 0; i < 6; ++i) {
+        BOOST_CHECK_EQUAL(vd[id[i]*3], expected[i][0]);
+        BOOST_CHECK_EQUAL(vd[id[i]*3+1], expected[i][1]);
+        BOOST_CHECK_EQUAL(td[id[i]*2] + td[id[i]*2+1], expected[i][2]);
+    }
+    delete resource.GetSceneNode();
+}
+
+// the shared vertices of the file do not fit 16 bit indices, so the
+// mesh is split instead of getting truncated indices
+BOOST_AUTO_TEST_CASE(WideMeshesAreSplit) {
+    const unsigned int triangles = 0x10000 / 3 + 100;
+    std::ostringstream text;
+    for (unsigned int i = 0; i < triangles * 3; ++i)
+        text << "v " << i << " " << i % 7 << " " << i % 3 << "\n";
+    for (unsigned int i = 0; i < triangles; ++i)
+        text << "f " << i*3 + 1 << " " << i*3 + 2 << " " << i*3 + 3 << "\n";
+    OBJResource resource(WriteTestFile("index_wide.obj", text.str()));
+    resource.Load();
+
+    const vector<OBJChunk>& chunks = resource.GetChunks();
+    BOOST_REQUIRE_GT(chunks.size(), 1u);
+    unsigned int indices = 0;
+    for (unsigned int i = 0; i < chunks.size(); ++i) {
+        IndicesPtr is = chunks[i].mesh->GetIndices();
+        const unsigned int vertices = chunks[i].mesh->GetGeometrySet()->GetVertices()->GetSize();
+        BOOST_CHECK_LE(vertices, 0xFFFFu);
+        const unsigned short* id = (const unsigned short*)is->GetVoidDataPtr();
+        for (unsigned int j = 0; j < is->GetSize(); ++j)
+            BOOST_REQUIRE_LT(id[j], vertices);
+        indices += is->GetSize();
+    }
+    BOOST_CHECK_EQUAL(indices, triangles * 3);
+    delete resource.GetSceneNode();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
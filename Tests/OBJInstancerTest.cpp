@@ -0,0 +1,109 @@
+// OBJ instance detection tests.
+// -------------------------------------------------------------------
+// Copyright (C) 2007 OpenEngine.dk (See AUTHORS)
+//
+// This program is free software; It is covered by the GNU General
+// Public License version 2 or any later version.
+// See the GNU General Public License for more details (see LICENSE).
+//--------------------------------------------------------------------
+
+#include "OBJTestFile.h"
+#include <Resources/OBJResource.h>
+#include <Geometry/GeometrySet.h>
+#include <Scene/MeshNode.h>
+#include <Scene/TransformationNode.h>
+
+#include <boost/test/unit_test.hpp>
+#include <cmath>
+#include <sstream>
+
+using namespace OpenEngine::Resources;
+using namespace OpenEngine::Scene;
+
+// corners of a small pyramid, four triangles with unshared vertices
+static const float PYRAMID[12][3] = {
+    {0,0,0}, {2,0,0}, {0,1,0},
+    {0,0,0}, {0,1,0}, {0,0,3},
+    {0,0,0}, {0,0,3}, {2,0,0},
+    {2,0,0}, {0,0,3}, {0,1,0} };
+
+/**
+ * Get a pyramid corner rotated about the z axis and moved along x.
+ */
+static Vector<3,float> Copy(unsigned int copy, unsigned int corner) {
+    const float a = 0.7f * copy, c = cos(a), s = sin(a);
+    const float* p = PYRAMID[corner];
+    return Vector<3,float>(c * p[0] - s * p[1] + 10.0f * copy, s * p[0] + c * p[1], p[2]);
+}
+
+/**
+ * Write an object for each copy of the pyramid.
+ */
+static string Pyramids(unsigned int copies) {
+    std::ostringstream text;
+    text.precision(9);
+    for (unsigned int i = 0; i < copies; ++i) {
+        text << "o pyramid" << i << "\n";
+        for (unsigned int c = 0; c < 12; ++c) {
+            Vector<3,float> p = Copy(i, c);
+            text << "v " << p[0] << " " << p[1] << " " << p[2] << "\n";
+        }
+        for (unsigned int t = 0; t < 4; ++t)
+            text << "f " << i*12 + t*3 + 1 << " " << i*12 + t*3 + 2 << " " << i*12 + t*3 + 3 << "\n";
+    }
+    return text.str();
+}
+
+BOOST_AUTO_TEST_SUITE(OBJInstancerTest)
+
+// every object is a rotated copy, so no triangle mesh is left besides
+// the shared one of the instances
+BOOST_AUTO_TEST_CASE(RotatedCopiesBecomeInstances) {
+    const unsigned int copies = 3;
+    OBJLoadOptions options;
+    options.detectInstances = true;
+    OBJResource resource(WriteTestFile("instances_rotated.obj", Pyramids(copies)), options);
+    resource.Load();
+    ISceneNode* root = resource.GetSceneNode();
+
+    BOOST_CHECK_EQUAL(resource.GetLoadStatistics().instancedObjects, copies);
+    BOOST_CHECK(resource.GetMeshes().empty());
+
+    // the root holds nothing but the instances
+    BOOST_REQUIRE_EQUAL(root->GetNumberOfNodes(), 1u);
+    ISceneNode* instances = root->GetNode(0)->GetNode(0);
+    BOOST_REQUIRE_EQUAL(instances->GetNumberOfNodes(), copies);
+    MeshPtr mesh = dynamic_cast<MeshNode*>(instances->GetNode(0)->GetNode(0))->GetMesh();
+    BOOST_REQUIRE_EQUAL(mesh->GetIndices()->GetSize(), 12u);
+    const unsigned short* id = (const unsigned short*)mesh->GetIndices()->GetVoidDataPtr();
+    const float* vd = (const float*)mesh->GetGeometrySet()->GetVertices()->GetVoidDataPtr();
+    for (unsigned int i = 0; i < copies; ++i) {
+        TransformationNode* trans = dynamic_cast<TransformationNode*>(instances->GetNode(i));
+        BOOST_REQUIRE(trans);
+        BOOST_CHECK(dynamic_cast<MeshNode*>(trans->GetNode(0))->GetMesh() == mesh);
+        // the transformation puts the shared mesh back in place
+        for (unsigned int c = 0; c < 12; ++c) {
+            const float* l = &vd[id[c]*3];
+            Vector<3,float> p = trans->GetRotation().RotateVector(Vector<3,float>(l[0], l[1], l[2]))
+                + trans->GetPosition();
+            BOOST_CHECK_SMALL((p - Copy(i, c)).GetLength(), 1e-4f);
+        }
+    }
+    delete root;
+}
+
+BOOST_AUTO_TEST_CASE(UniqueObjectsKeepTheMainMesh) {
+    string text = Pyramids(2) + "o other\nv 0 0 50\nv 1 0 50\nv 0 1 50\nf 25 26 27\n";
+    OBJLoadOptions options;
+    options.detectInstances = true;
+    OBJResource resource(WriteTestFile("instances_unique.obj", text), options);
+    resource.Load();
+    delete resource.GetSceneNode();
+
+    BOOST_CHECK_EQUAL(resource.GetLoadStatistics().instancedObjects, 2u);
+    vector<MeshPtr> meshes = resource.GetMeshes();
+    BOOST_REQUIRE_EQUAL(meshes.size(), 1u);
+    BOOST_CHECK_EQUAL(meshes[0]->GetIndices()->GetSize(), 3u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,96 @@
+// OBJ buffer loading tests.
+// -------------------------------------------------------------------
+// Copyright (C) 2007 OpenEngine.dk (See AUTHORS)
+//
+// This program is free software; It is covered by the GNU General
+// Public License version 2 or any later version.
+// See the GNU General Public License for more details (see LICENSE).
+//--------------------------------------------------------------------
+
+#include "OBJTestFile.h"
+#include <Resources/OBJResource.h>
+
+#include <boost/test/unit_test.hpp>
+
+using namespace OpenEngine::Resources;
+
+static const char* QUAD =
+    "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\n"
+    "f 1 2 3\nf 1 3 4\n";
+
+/**
+ * Load a resource into buffers sized by QuerySizes().
+ */
+static bool LoadBuffers(OBJResource& resource, vector<float>& positions,
+                        vector<unsigned int>& indices, vector<unsigned int>& points) {
+    OBJBufferSizes sizes = resource.QuerySizes();
+    positions.assign(sizes.vertexCount * 3 + 1, 0.0f);
+    indices.assign(sizes.indexCount + 1, 0);
+    points.assign(sizes.pointIndexCount + 1, 0);
+    OBJBufferLayout layout;
+    layout.positions = &positions[0];
+    layout.indices = &indices[0];
+    layout.pointIndices = &points[0];
+    layout.indexSize = 4;
+    bool loaded = resource.LoadInto(layout);
+    positions.pop_back();
+    indices.pop_back();
+    points.pop_back();
+    return loaded;
+}
+
+BOOST_AUTO_TEST_SUITE(OBJLoadIntoTest)
+
+BOOST_AUTO_TEST_CASE(TrianglesAreWrittenToBuffers) {
+    OBJResource resource(WriteTestFile("loadinto_quad.obj", QUAD));
+    vector<float> positions;
+    vector<unsigned int> indices, points;
+    BOOST_REQUIRE(LoadBuffers(resource, positions, indices, points));
+    BOOST_REQUIRE_EQUAL(indices.size(), 6u);
+    BOOST_CHECK(points.empty());
+    // every corner points at the position it had in the file
+    const float corners[6][2] = { {0,0}, {1,0}, {1,1}, {0,0}, {1,1}, {0,1} };
+    for (unsigned int i = 0; i < 6; ++i) {
+        BOOST_REQUIRE_LT(indices[i] * 3 + 2, positions.size());
+        BOOST_CHECK_EQUAL(positions[indices[i]*3], corners[i][0]);
+        BOOST_CHECK_EQUAL(positions[indices[i]*3+1], corners[i][1]);
+    }
+}
+
+// the kept data is released by the first call, so the second one
+// parses the file again
+BOOST_AUTO_TEST_CASE(LoadIntoTwice) {
+    OBJResource resource(WriteTestFile("loadinto_twice.obj", QUAD));
+    vector<float> positions, again;
+    vector<unsigned int> indices, points;
+    BOOST_REQUIRE(LoadBuffers(resource, positions, indices, points));
+    BOOST_REQUIRE(LoadBuffers(resource, again, indices, points));
+    BOOST_CHECK(positions == again);
+    BOOST_CHECK_EQUAL(indices.size(), 6u);
+}
+
+BOOST_AUTO_TEST_CASE(NothingToWriteAfterLoad) {
+    OBJResource resource(WriteTestFile("loadinto_loaded.obj", QUAD));
+    resource.Load();
+    BOOST_REQUIRE(resource.GetSceneNode());
+    OBJBufferSizes sizes = resource.QuerySizes();
+    BOOST_CHECK_EQUAL(sizes.vertexCount, 0u);
+    BOOST_CHECK_EQUAL(sizes.indexCount, 0u);
+    OBJBufferLayout layout;
+    BOOST_CHECK(!resource.LoadInto(layout));
+    delete resource.GetSceneNode();
+}
+
+BOOST_AUTO_TEST_CASE(VerticesOnlyAreWrittenAsPoints) {
+    OBJResource resource(WriteTestFile("loadinto_points.obj", "v 1 2 3\nv 4 5 6\nv 7 8 9\n"));
+    vector<float> positions;
+    vector<unsigned int> indices, points;
+    BOOST_REQUIRE(LoadBuffers(resource, positions, indices, points));
+    BOOST_CHECK(indices.empty());
+    BOOST_REQUIRE_EQUAL(points.size(), 3u);
+    BOOST_REQUIRE_EQUAL(positions.size(), 9u);
+    for (unsigned int i = 0; i < 3; ++i)
+        BOOST_CHECK_EQUAL(positions[points[i]*3], float(i*3 + 1));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
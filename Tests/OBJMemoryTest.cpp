@@ -0,0 +1,97 @@
+// OBJ memory accounting tests.
+// -------------------------------------------------------------------
+// Copyright (C) 2007 OpenEngine.dk (See AUTHORS)
+//
+// This program is free software; It is covered by the GNU General
+// Public License version 2 or any later version.
+// See the GNU General Public License for more details (see LICENSE).
+//--------------------------------------------------------------------
+
+#include "OBJTestFile.h"
+#include <Resources/OBJResource.h>
+#include <Geometry/GeometrySet.h>
+
+#include <boost/test/unit_test.hpp>
+#include <sstream>
+
+using namespace OpenEngine::Resources;
+
+/**
+ * Load a resource and get the positions and indices of its single
+ * mesh.
+ */
+static void LoadArrays(OBJResource& resource, vector<float>& vertices,
+                       vector<unsigned short>& indices) {
+    resource.Unload();
+    resource.Load();
+    delete resource.GetSceneNode();
+    BOOST_REQUIRE_EQUAL(resource.GetMeshes().size(), 1u);
+    MeshPtr mesh = resource.GetMeshes()[0];
+    const float* vd = (const float*)mesh->GetGeometrySet()->GetVertices()->GetVoidDataPtr();
+    const unsigned short* id = (const unsigned short*)mesh->GetIndices()->GetVoidDataPtr();
+    vertices.assign(vd, vd + mesh->GetGeometrySet()->GetVertices()->GetSize() * 3);
+    indices.assign(id, id + mesh->GetIndices()->GetSize());
+}
+
+BOOST_AUTO_TEST_SUITE(OBJMemoryTest)
+
+// the material map outlived Unload(), so the totals kept counting
+// materials of resources that were gone
+BOOST_AUTO_TEST_CASE(UnloadReleasesEverything) {
+    WriteTestFile("memory.mtl", "newmtl used\nKd 1 0 0\nnewmtl unused\nKd 0 1 0\n");
+    const string file = WriteTestFile("memory.obj",
+        "mtllib memory.mtl\nv 0 0 0\nv 1 0 0\nv 0 1 0\nusemtl used\nf 1 2 3\n");
+    const boost::uint64_t before = OBJPlugin::GetMemoryUsage().GetTotalBytes();
+    {
+        OBJResource resource(file);
+        resource.Load();
+        delete resource.GetSceneNode();
+        BOOST_CHECK_GT(resource.GetMemoryUsage().materialBytes, 0u);
+        BOOST_CHECK_GT(OBJPlugin::GetMemoryUsage().GetTotalBytes(), before);
+
+        resource.Unload();
+        BOOST_CHECK_EQUAL(resource.GetMemoryUsage().GetTotalBytes(), 0u);
+        BOOST_CHECK_EQUAL(OBJPlugin::GetMemoryUsage().GetTotalBytes(), before);
+
+        // loading again counts the materials once more, not twice
+        resource.Load();
+        delete resource.GetSceneNode();
+    }
+    BOOST_CHECK_EQUAL(OBJPlugin::GetMemoryUsage().GetTotalBytes(), before);
+}
+
+// the parse buffers of the thread keep their storage between loads,
+// until they are trimmed
+BOOST_AUTO_TEST_CASE(ParseBuffersAreReused) {
+    std::ostringstream text;
+    for (unsigned int i = 0; i < 1000; ++i)
+        text << "v " << i << " " << i % 5 << " 0\n";
+    for (unsigned int i = 0; i + 2 < 1000; ++i)
+        text << "f " << i + 1 << " " << i + 2 << " " << i + 3 << "\n";
+    OBJResource large(WriteTestFile("memory_large.obj", text.str()));
+    OBJResource small(WriteTestFile("memory_small.obj", "v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 3\n"));
+    vector<float> vertices[2], largeVertices[2];
+    vector<unsigned short> indices[2], largeIndices[2];
+
+    OBJResource::TrimParseBuffers();
+    LoadArrays(small, vertices[0], indices[0]);
+    const boost::uint64_t fresh = small.GetMemoryUsage().peakTemporaryBytes;
+
+    // the small load runs in the buffers grown by the large one
+    LoadArrays(large, largeVertices[0], largeIndices[0]);
+    LoadArrays(small, vertices[1], indices[1]);
+    BOOST_CHECK_GT(small.GetMemoryUsage().peakTemporaryBytes, fresh);
+    BOOST_CHECK(vertices[0] == vertices[1]);
+    BOOST_CHECK(indices[0] == indices[1]);
+    LoadArrays(large, largeVertices[1], largeIndices[1]);
+    BOOST_CHECK(largeVertices[0] == largeVertices[1]);
+    BOOST_CHECK(largeIndices[0] == largeIndices[1]);
+    BOOST_CHECK_EQUAL(largeIndices[1].size(), 998u * 3);
+
+    OBJResource::TrimParseBuffers();
+    LoadArrays(small, vertices[1], indices[1]);
+    BOOST_CHECK_EQUAL(small.GetMemoryUsage().peakTemporaryBytes, fresh);
+    BOOST_CHECK(vertices[0] == vertices[1]);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
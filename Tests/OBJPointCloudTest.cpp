@@ -0,0 +1,136 @@
+// OBJ point cloud tests.
+// -------------------------------------------------------------------
+// Copyright (C) 2007 OpenEngine.dk (See AUTHORS)
+//
+// This program is free software; It is covered by the GNU General
+// Public License version 2 or any later version.
+// See the GNU General Public License for more details (see LICENSE).
+//--------------------------------------------------------------------
+
+#include "OBJTestFile.h"
+#include <Resources/OBJResource.h>
+#include <Resources/OBJPointCloud.h>
+#include <Geometry/GeometrySet.h>
+
+#include <boost/test/unit_test.hpp>
+#include <sstream>
+
+using namespace OpenEngine::Resources;
+
+/**
+ * Load a file of vertices as a point cloud and get its meshes.
+ */
+static vector<MeshPtr> LoadCloud(string file, unsigned int& points, unsigned int& invalid,
+                                 bool quantize = false) {
+    OBJLoadOptions options;
+    options.pointCloud = true;
+    options.quantizeColors = quantize;
+    OBJResource resource(file, options);
+    resource.Load();
+    points = resource.GetLoadStatistics().cloudPoints;
+    invalid = resource.GetErrors().empty() ? 0 : resource.GetErrors()[0].count;
+    vector<MeshPtr> meshes = resource.GetMeshes();
+    delete resource.GetSceneNode();
+    return meshes;
+}
+
+BOOST_AUTO_TEST_SUITE(OBJPointCloudTest)
+
+// dropping the invalid records empties the last slice, which must not
+// be built as a full one
+BOOST_AUTO_TEST_CASE(InvalidVerticesAreCompactedAway) {
+    const unsigned int count = OBJPointCloud::SLICE_SIZE + 10, bad = 20;
+    std::ostringstream text;
+    for (unsigned int i = 0; i < count; ++i)
+        if (i % 1000 == 0 && i / 1000 < bad)
+            text << "v " << i << " 0\n";
+        else
+            text << "v " << i << " 1 2\n";
+    unsigned int points, invalid;
+    vector<MeshPtr> meshes = LoadCloud(WriteTestFile("cloud_invalid.obj", text.str()), points, invalid);
+
+    BOOST_CHECK_EQUAL(points, count - bad);
+    BOOST_CHECK_EQUAL(invalid, bad);
+    BOOST_REQUIRE_EQUAL(meshes.size(), 1u);
+    IDataBlockPtr vertices = meshes[0]->GetGeometrySet()->GetVertices();
+    BOOST_CHECK_EQUAL(vertices->GetSize(), count - bad);
+    BOOST_CHECK_EQUAL(meshes[0]->GetIndices()->GetSize(), count - bad);
+    // the kept points are in file order
+    const float* vd = (const float*)vertices->GetVoidDataPtr();
+    BOOST_CHECK_EQUAL(vd[0], 1.0f);
+    BOOST_CHECK_EQUAL(vd[(count - bad - 1)*3], float(count - 1));
+}
+
+BOOST_AUTO_TEST_CASE(AllVerticesInvalid) {
+    unsigned int points, invalid;
+    vector<MeshPtr> meshes = LoadCloud(WriteTestFile("cloud_empty.obj", "v 1\nv 2 3\n"), points, invalid);
+    BOOST_CHECK_EQUAL(points, 0u);
+    BOOST_CHECK_EQUAL(invalid, 2u);
+    BOOST_CHECK(meshes.empty());
+}
+
+BOOST_AUTO_TEST_CASE(UncoloredCloudHasNoColors) {
+    unsigned int points, invalid;
+    vector<MeshPtr> meshes = LoadCloud(WriteTestFile("cloud_plain.obj", "v 1 2 3\nv 4 5 6\n"),
+                                       points, invalid);
+    BOOST_REQUIRE_EQUAL(meshes.size(), 1u);
+    BOOST_CHECK(!meshes[0]->GetGeometrySet()->GetColors());
+}
+
+// the first vertex has no colour, so the colours are only found on
+// the way, and points without one are white
+BOOST_AUTO_TEST_CASE(LateColorsAreKept) {
+    unsigned int points, invalid;
+    vector<MeshPtr> meshes = LoadCloud(WriteTestFile("cloud_late.obj",
+        "v 1 2 3\nv 4 5 6 0 0.5 1\nv 7\nv 8 9 10 1 0 0\n"), points, invalid);
+    BOOST_CHECK_EQUAL(points, 3u);
+    BOOST_CHECK_EQUAL(invalid, 1u);
+    BOOST_REQUIRE_EQUAL(meshes.size(), 1u);
+    IDataBlockPtr colors = meshes[0]->GetGeometrySet()->GetColors();
+    BOOST_REQUIRE(colors);
+    BOOST_REQUIRE_EQUAL(colors->GetDimension(), 3u);
+    BOOST_REQUIRE_EQUAL(colors->GetSize(), 3u);
+    const float* cd = (const float*)colors->GetVoidDataPtr();
+    const float expected[] = { 1,1,1, 0,0.5f,1, 1,0,0 };
+    for (unsigned int i = 0; i < 9; ++i)
+        BOOST_CHECK_EQUAL(cd[i], expected[i]);
+}
+
+BOOST_AUTO_TEST_CASE(QuantizedCloudColors) {
+    unsigned int points, invalid;
+    vector<MeshPtr> meshes = LoadCloud(WriteTestFile("cloud_bytes.obj",
+        "v 1 2 3 1 0 0.5\nv 4 5 6\n"), points, invalid, true);
+    BOOST_REQUIRE_EQUAL(meshes.size(), 1u);
+    IDataBlockPtr colors = meshes[0]->GetGeometrySet()->GetColors();
+    BOOST_REQUIRE(colors);
+    BOOST_REQUIRE_EQUAL(colors->GetDimension(), 4u);
+    const unsigned char* cd = (const unsigned char*)colors->GetVoidDataPtr();
+    const unsigned char expected[] = { 255,0,128,255, 255,255,255,255 };
+    for (unsigned int i = 0; i < 8; ++i)
+        BOOST_CHECK_EQUAL(int(cd[i]), int(expected[i]));
+}
+
+// without the point cloud option a file of nothing but vertices is
+// still loaded as points, from the parsed vertices
+BOOST_AUTO_TEST_CASE(VerticesOnlyFallBackToPoints) {
+    OBJResource resource(WriteTestFile("cloud_fallback.obj",
+        "v 1 2 3 1 0 0\nv 4 5 6 0 1 0\nv 7 8 9\n"));
+    resource.Load();
+    delete resource.GetSceneNode();
+    BOOST_CHECK_EQUAL(resource.GetLoadStatistics().cloudPoints, 3u);
+    vector<MeshPtr> meshes = resource.GetMeshes();
+    BOOST_REQUIRE_EQUAL(meshes.size(), 1u);
+    BOOST_CHECK_EQUAL(meshes[0]->GetType(), POINTS);
+    GeometrySetPtr gs = meshes[0]->GetGeometrySet();
+    BOOST_REQUIRE_EQUAL(gs->GetVertices()->GetSize(), 3u);
+    const float* vd = (const float*)gs->GetVertices()->GetVoidDataPtr();
+    for (unsigned int i = 0; i < 9; ++i)
+        BOOST_CHECK_EQUAL(vd[i], float(i + 1));
+    BOOST_REQUIRE(gs->GetColors());
+    const float* cd = (const float*)gs->GetColors()->GetVoidDataPtr();
+    const float expected[] = { 1,0,0, 0,1,0, 1,1,1 };
+    for (unsigned int i = 0; i < 9; ++i)
+        BOOST_CHECK_EQUAL(cd[i], expected[i]);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,77 @@
+// OBJ load profile tests.
+// -------------------------------------------------------------------
+// Copyright (C) 2007 OpenEngine.dk (See AUTHORS)
+//
+// This program is free software; It is covered by the GNU General
+// Public License version 2 or any later version.
+// See the GNU General Public License for more details (see LICENSE).
+//--------------------------------------------------------------------
+
+#include "OBJTestFile.h"
+#include <Resources/OBJResource.h>
+
+#include <boost/test/unit_test.hpp>
+#include <algorithm>
+
+using namespace OpenEngine::Resources;
+
+static const string MTL = "newmtl red\nKd 1 0 0\nnewmtl green\nKd 0 1 0\n";
+static const string OBJ =
+    "mtllib profile.mtl\n"
+    "v 0 0 0\nv 1 0 0\nv 0 1 0\nv 1 1 0\n"
+    "vn 0 0 1\nvt 0 0\nvt 1 1\n"
+    "usemtl red\nf 1/1/1 2/2/1 3/1/1\n"
+    "usemtl green\nf 2/1/1 4/2/1 3/2/1\n"
+    "l 1 2 3\np 4\n";
+
+/**
+ * Load a file and get its profile.
+ */
+static OBJLoadProfile Profile(string file, bool profile, bool pointCloud = false) {
+    OBJLoadOptions options;
+    options.profile = profile;
+    options.pointCloud = pointCloud;
+    OBJResource resource(file, options);
+    resource.Load();
+    delete resource.GetSceneNode();
+    return resource.GetLoadProfile();
+}
+
+BOOST_AUTO_TEST_SUITE(OBJProfileTest)
+
+BOOST_AUTO_TEST_CASE(CountsArePopulated) {
+    WriteTestFile("profile.mtl", MTL);
+    const OBJLoadProfile p = Profile(WriteTestFile("profile.obj", OBJ), true);
+    BOOST_CHECK_EQUAL(p.bytesRead, OBJ.size() + MTL.size());
+    BOOST_CHECK_EQUAL(p.lines, (unsigned int)std::count(OBJ.begin(), OBJ.end(), '\n'));
+    BOOST_CHECK_EQUAL(p.vertices, 4u);
+    BOOST_CHECK_EQUAL(p.normals, 1u);
+    BOOST_CHECK_EQUAL(p.texcoords, 2u);
+    BOOST_CHECK_EQUAL(p.faces, 2u);
+    BOOST_CHECK_EQUAL(p.segments, 2u);
+    BOOST_CHECK_EQUAL(p.points, 1u);
+    BOOST_CHECK_EQUAL(p.materialFiles, 1u);
+    BOOST_CHECK_EQUAL(p.materials, 2u);
+    BOOST_CHECK_EQUAL(p.textures, 0u);
+    // the phases are laps of the whole load
+    BOOST_CHECK_GE(p.totalTime, p.openTime + p.geometryTime + p.materialTime +
+                   p.textureTime + p.processingTime + p.buildingTime);
+}
+
+BOOST_AUTO_TEST_CASE(TimesNeedProfiling) {
+    WriteTestFile("profile.mtl", MTL);
+    const OBJLoadProfile p = Profile(WriteTestFile("profile_off.obj", OBJ), false);
+    BOOST_CHECK_EQUAL(p.totalTime, 0u);
+    BOOST_CHECK_EQUAL(p.geometryTime, 0u);
+    BOOST_CHECK_EQUAL(p.vertices, 4u);
+    BOOST_CHECK_EQUAL(p.faces, 2u);
+}
+
+BOOST_AUTO_TEST_CASE(PointCloudCountsBytes) {
+    const string text = "v 1 2 3\nv 4 5 6\nv 7 8 9\n";
+    const OBJLoadProfile p = Profile(WriteTestFile("profile_cloud.obj", text), true, true);
+    BOOST_CHECK_EQUAL(p.bytesRead, text.size());
+    BOOST_CHECK_EQUAL(p.vertices, 3u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
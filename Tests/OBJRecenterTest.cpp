@@ -0,0 +1,75 @@
+// OBJ recentering tests.
+// -------------------------------------------------------------------
+// Copyright (C) 2007 OpenEngine.dk (See AUTHORS)
+//
+// This program is free software; It is covered by the GNU General
+// Public License version 2 or any later version.
+// See the GNU General Public License for more details (see LICENSE).
+//--------------------------------------------------------------------
+
+#include "OBJTestFile.h"
+#include <Resources/OBJResource.h>
+#include <Geometry/GeometrySet.h>
+#include <Scene/TransformationNode.h>
+
+#include <boost/test/unit_test.hpp>
+
+using namespace OpenEngine::Resources;
+using namespace OpenEngine::Scene;
+
+// the fractions are lost when the coordinates are stored as floats
+static const char* FAR_AWAY =
+    "v 10000000.125 20000000.5 0\n"
+    "v 10000001.125 20000000.5 0\n"
+    "v 10000000.125 20000002.5 0\n";
+
+// positions centered on the bounding box
+static const float CENTERED[] = { -0.5f,-1,0, 0.5f,-1,0, -0.5f,1,0 };
+
+/**
+ * Load a file recentered and check the positions of its single mesh.
+ */
+static void CheckRecentered(string file, bool pointCloud) {
+    OBJLoadOptions options;
+    options.recenter = true;
+    options.pointCloud = pointCloud;
+    OBJResource resource(file, options);
+    resource.Load();
+    ISceneNode* node = resource.GetSceneNode();
+    // the node moves the meshes back into place
+    BOOST_CHECK(dynamic_cast<TransformationNode*>(node));
+    delete node;
+
+    const Vector<3,double> origin = resource.GetOrigin();
+    BOOST_CHECK_EQUAL(origin[0], 10000000.625);
+    BOOST_CHECK_EQUAL(origin[1], 20000001.5);
+    BOOST_CHECK_EQUAL(origin[2], 0.0);
+    vector<MeshPtr> meshes = resource.GetMeshes();
+    BOOST_REQUIRE_EQUAL(meshes.size(), 1u);
+    IDataBlockPtr vertices = meshes[0]->GetGeometrySet()->GetVertices();
+    BOOST_REQUIRE_EQUAL(vertices->GetSize(), 3u);
+    const float* vd = (const float*)vertices->GetVoidDataPtr();
+    for (unsigned int i = 0; i < 9; ++i)
+        BOOST_CHECK_EQUAL(vd[i], CENTERED[i]);
+}
+
+BOOST_AUTO_TEST_SUITE(OBJRecenterTest)
+
+BOOST_AUTO_TEST_CASE(RecenteredMeshKeepsPrecision) {
+    CheckRecentered(WriteTestFile("recenter.obj", string(FAR_AWAY) + "f 1 2 3\n"), false);
+}
+
+BOOST_AUTO_TEST_CASE(RecenteredCloudKeepsPrecision) {
+    CheckRecentered(WriteTestFile("recenter_cloud.obj", FAR_AWAY), true);
+}
+
+BOOST_AUTO_TEST_CASE(OriginIsZeroWithoutRecenter) {
+    OBJResource resource(WriteTestFile("recenter_off.obj", string(FAR_AWAY) + "f 1 2 3\n"));
+    resource.Load();
+    delete resource.GetSceneNode();
+    BOOST_CHECK_EQUAL(resource.GetOrigin()[0], 0.0);
+    const float* vd = (const float*)resource.GetMeshes()[0]->GetGeometrySet()->GetVertices()->GetVoidDataPtr();
+    BOOST_CHECK_EQUAL(vd[0], 10000000.0f);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,83 @@
+// OBJ spatial sorting tests.
+// -------------------------------------------------------------------
+// Copyright (C) 2007 OpenEngine.dk (See AUTHORS)
+//
+// This program is free software; It is covered by the GNU General
+// Public License version 2 or any later version.
+// See the GNU General Public License for more details (see LICENSE).
+//--------------------------------------------------------------------
+
+#include <Resources/OBJSpatialSort.h>
+#include <Resources/OBJMeshData.h>
+
+#include <boost/test/unit_test.hpp>
+#include <algorithm>
+#include <utility>
+
+using namespace OpenEngine::Resources;
+
+BOOST_AUTO_TEST_SUITE(OBJSpatialSortTest)
+
+BOOST_AUTO_TEST_CASE(MortonCodeInterleavesXYZ) {
+    const float step = 1.0f / 1024.0f;
+    BOOST_CHECK_EQUAL(OBJSpatialSort::MortonCode(0, 0, 0), 0u);
+    BOOST_CHECK_EQUAL(OBJSpatialSort::MortonCode(step, 0, 0), 4u);
+    BOOST_CHECK_EQUAL(OBJSpatialSort::MortonCode(0, step, 0), 2u);
+    BOOST_CHECK_EQUAL(OBJSpatialSort::MortonCode(0, 0, step), 1u);
+    BOOST_CHECK_EQUAL(OBJSpatialSort::MortonCode(1, 1, 1), 0x3FFFFFFFu);
+    // outside the unit cube is clamped
+    BOOST_CHECK_EQUAL(OBJSpatialSort::MortonCode(-1, 2, 0), OBJSpatialSort::MortonCode(0, 1, 0));
+}
+
+// enough keys for several chunks, with repeated keys to show the
+// sort is stable
+BOOST_AUTO_TEST_CASE(RadixSortIsStable) {
+    const unsigned int n = 100000;
+    vector<unsigned int> keys(n), values(n);
+    vector<std::pair<unsigned int, unsigned int> > expected(n);
+    for (unsigned int i = 0; i < n; ++i) {
+        keys[i] = ((i * 2654435761u) >> 7) & 0xFF00FF0Fu;
+        values[i] = i;
+        expected[i] = std::make_pair(keys[i], i);
+    }
+    std::stable_sort(expected.begin(), expected.end());
+    OBJSpatialSort::RadixSort(keys, values);
+    for (unsigned int i = 0; i < n; ++i) {
+        BOOST_REQUIRE_EQUAL(keys[i], expected[i].first);
+        BOOST_REQUIRE_EQUAL(values[i], expected[i].second);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(SortOrdersTrianglesAndVertices) {
+    // triangles along the x axis, stored from right to left
+    const unsigned int count = 8;
+    OBJMeshData data(count * 3, count);
+    for (unsigned int t = 0; t < count; ++t)
+        for (unsigned int k = 0; k < 3; ++k) {
+            const unsigned int v = t*3 + k;
+            data.vertices[v*3] = float(count - 1 - t) + (k == 1 ? 0.5f : 0.0f);
+            data.vertices[v*3+1] = k == 2 ? 0.5f : 0.0f;
+            data.vertices[v*3+2] = 0.0f;
+            std::fill(data.normals + v*3, data.normals + v*3 + 3, 0.0f);
+            std::fill(data.texcoords + v*2, data.texcoords + v*2 + 2, 0.0f);
+            data.indices[v] = v;
+        }
+    for (unsigned int t = 0; t < count; ++t)
+        data.materials[t] = t;
+    OBJSpatialSort::Sort(data);
+
+    BOOST_REQUIRE_EQUAL(data.triangleCount, count);
+    BOOST_REQUIRE_EQUAL(data.vertexCount, count * 3);
+    for (unsigned int t = 0; t < count; ++t) {
+        // left to right, each with its material and corners in order
+        BOOST_CHECK_EQUAL(data.materials[t], count - 1 - t);
+        for (unsigned int k = 0; k < 3; ++k) {
+            // vertices are numbered in first use order
+            BOOST_CHECK_EQUAL(data.indices[t*3+k], t*3 + k);
+            BOOST_CHECK_EQUAL(data.vertices[data.indices[t*3+k]*3],
+                              float(t) + (k == 1 ? 0.5f : 0.0f));
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,104 @@
+// OBJ triangle strip tests.
+// -------------------------------------------------------------------
+// Copyright (C) 2007 OpenEngine.dk (See AUTHORS)
+//
+// This program is free software; It is covered by the GNU General
+// Public License version 2 or any later version.
+// See the GNU General Public License for more details (see LICENSE).
+//--------------------------------------------------------------------
+
+#include <Resources/OBJStripifier.h>
+
+#include <boost/test/unit_test.hpp>
+#include <algorithm>
+
+using namespace OpenEngine::Resources;
+
+/**
+ * Get a triangle rotated so its smallest index comes first, which
+ * keeps the winding.
+ */
+static vector<unsigned int> Rotated(unsigned int a, unsigned int b, unsigned int c) {
+    vector<unsigned int> t(3);
+    if (a <= b && a <= c) { t[0] = a; t[1] = b; t[2] = c; }
+    else if (b <= c)      { t[0] = b; t[1] = c; t[2] = a; }
+    else                  { t[0] = c; t[1] = a; t[2] = b; }
+    return t;
+}
+
+/**
+ * Get the sorted triangles of a triangle list.
+ */
+static vector< vector<unsigned int> > ListTriangles(const unsigned int* indices, unsigned int count) {
+    vector< vector<unsigned int> > tris;
+    for (unsigned int i = 0; i < count; ++i)
+        tris.push_back(Rotated(indices[i*3], indices[i*3+1], indices[i*3+2]));
+    std::sort(tris.begin(), tris.end());
+    return tris;
+}
+
+/**
+ * Get the sorted triangles drawn by restarted strips, with every
+ * other triangle of a strip reversed.
+ */
+static vector< vector<unsigned int> > StripTriangles(const vector<unsigned int>& strip) {
+    vector< vector<unsigned int> > tris;
+    unsigned int start = 0;
+    for (unsigned int i = 0; i <= strip.size(); ++i) {
+        if (i < strip.size() && strip[i] != OBJStripifier::RESTART) continue;
+        for (unsigned int j = start; j + 2 < i; ++j) {
+            const unsigned int* s = &strip[j];
+            if ((j - start) % 2 == 0)
+                tris.push_back(Rotated(s[0], s[1], s[2]));
+            else
+                tris.push_back(Rotated(s[1], s[0], s[2]));
+        }
+        start = i + 1;
+    }
+    std::sort(tris.begin(), tris.end());
+    return tris;
+}
+
+BOOST_AUTO_TEST_SUITE(OBJStripifierTest)
+
+BOOST_AUTO_TEST_CASE(GridKeepsTrianglesAndWinding) {
+    const unsigned int n = 8, count = n * n * 2;
+    vector<unsigned int> indices;
+    for (unsigned int y = 0; y < n; ++y)
+        for (unsigned int x = 0; x < n; ++x) {
+            const unsigned int v = y * (n+1) + x;
+            const unsigned int quad[] = { v, v+1, v+n+2,  v, v+n+2, v+n+1 };
+            indices.insert(indices.end(), quad, quad + 6);
+        }
+    vector<unsigned int> strip;
+    const unsigned int strips = OBJStripifier::Stripify(&indices[0], count, (n+1)*(n+1), strip);
+
+    BOOST_CHECK_GE(strips, 1u);
+    BOOST_CHECK_EQUAL((unsigned int)std::count(strip.begin(), strip.end(), OBJStripifier::RESTART),
+                      strips - 1);
+    BOOST_CHECK(StripTriangles(strip) == ListTriangles(&indices[0], count));
+    // strips across the grid beat the list
+    BOOST_CHECK_LT(strip.size(), indices.size());
+}
+
+// triangles without shared edges are separate strips, joined by
+// restarts and neither started nor ended by one
+BOOST_AUTO_TEST_CASE(DisconnectedTrianglesAreRestarted) {
+    const unsigned int indices[] = { 0, 1, 2,  3, 4, 5,  6, 7, 8 };
+    vector<unsigned int> strip;
+    BOOST_CHECK_EQUAL(OBJStripifier::Stripify(indices, 3, 9, strip), 3u);
+    BOOST_REQUIRE_EQUAL(strip.size(), 11u);
+    BOOST_CHECK_NE(strip.front(), OBJStripifier::RESTART);
+    BOOST_CHECK_NE(strip.back(), OBJStripifier::RESTART);
+    BOOST_CHECK_EQUAL(strip[3], OBJStripifier::RESTART);
+    BOOST_CHECK_EQUAL(strip[7], OBJStripifier::RESTART);
+    BOOST_CHECK(StripTriangles(strip) == ListTriangles(indices, 3));
+}
+
+BOOST_AUTO_TEST_CASE(NoTriangles) {
+    vector<unsigned int> strip(1, 7);
+    BOOST_CHECK_EQUAL(OBJStripifier::Stripify(NULL, 0, 0, strip), 0u);
+    BOOST_CHECK(strip.empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
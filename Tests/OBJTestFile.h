@@ -0,0 +1,32 @@
+// OBJ test files.
+// -------------------------------------------------------------------
+// Copyright (C) 2007 OpenEngine.dk (See AUTHORS)
+//
+// This program is free software; It is covered by the GNU General
+// Public License version 2 or any later version.
+// See the GNU General Public License for more details (see LICENSE).
+//--------------------------------------------------------------------
+
+#ifndef _OBJ_TEST_FILE_H_
+#define _OBJ_TEST_FILE_H_
+
+#include <cstdio>
+#include <string>
+
+/**
+ * Write a test file to the working directory.
+ *
+ * @param name File name
+ * @param text Contents of the file
+ * @return Path of the file
+ */
+inline std::string WriteTestFile(std::string name, std::string text) {
+    FILE* out = fopen(name.c_str(), "wb");
+    if (out) {
+        fwrite(text.data(), 1, text.size(), out);
+        fclose(out);
+    }
+    return name;
+}
+
+#endif // _OBJ_TEST_FILE_H_
@@ -0,0 +1,14 @@
+// OBJ resource tests.
+// -------------------------------------------------------------------
+// Copyright (C) 2007 OpenEngine.dk (See AUTHORS)
+//
+// This program is free software; It is covered by the GNU General
+// Public License version 2 or any later version.
+// See the GNU General Public License for more details (see LICENSE).
+//--------------------------------------------------------------------
+
+// Test runner of the OBJ loader and its passes. The tests of each
+// pass are in a file of their own.
+
+#define BOOST_TEST_MODULE OBJResource
+#include <boost/test/included/unit_test.hpp>
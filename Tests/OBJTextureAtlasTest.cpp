@@ -0,0 +1,77 @@
+// OBJ texture atlas tests.
+// -------------------------------------------------------------------
+// Copyright (C) 2007 OpenEngine.dk (See AUTHORS)
+//
+// This program is free software; It is covered by the GNU General
+// Public License version 2 or any later version.
+// See the GNU General Public License for more details (see LICENSE).
+//--------------------------------------------------------------------
+
+#include <Resources/OBJTextureAtlas.h>
+
+#include <boost/test/unit_test.hpp>
+
+using namespace OpenEngine::Resources;
+
+BOOST_AUTO_TEST_SUITE(OBJTextureAtlasTest)
+
+BOOST_AUTO_TEST_CASE(SquaresFillTheAtlas) {
+    OBJSkylinePacker packer(64, 64);
+    const unsigned int expected[4][2] = { {0,0}, {32,0}, {0,32}, {32,32} };
+    for (unsigned int i = 0; i < 4; ++i) {
+        unsigned int x, y;
+        BOOST_REQUIRE(packer.Insert(32, 32, x, y));
+        BOOST_CHECK_EQUAL(x, expected[i][0]);
+        BOOST_CHECK_EQUAL(y, expected[i][1]);
+    }
+    unsigned int x, y;
+    BOOST_CHECK(!packer.Insert(1, 1, x, y));
+}
+
+BOOST_AUTO_TEST_CASE(TooLargeIsRejected) {
+    OBJSkylinePacker packer(64, 32);
+    unsigned int x, y;
+    BOOST_CHECK(!packer.Insert(65, 1, x, y));
+    BOOST_CHECK(!packer.Insert(1, 33, x, y));
+    BOOST_CHECK(packer.Insert(64, 32, x, y));
+}
+
+// a rectangle drops into the lowest gap, not the leftmost
+BOOST_AUTO_TEST_CASE(LowestPositionWins) {
+    OBJSkylinePacker packer(64, 64);
+    unsigned int x, y;
+    BOOST_REQUIRE(packer.Insert(32, 40, x, y));
+    BOOST_REQUIRE(packer.Insert(16, 10, x, y));
+    BOOST_CHECK_EQUAL(x, 32u);
+    BOOST_REQUIRE(packer.Insert(16, 20, x, y));
+    BOOST_CHECK_EQUAL(x, 48u);
+    BOOST_CHECK_EQUAL(y, 0u);
+    BOOST_REQUIRE(packer.Insert(16, 5, x, y));
+    BOOST_CHECK_EQUAL(x, 32u);
+    BOOST_CHECK_EQUAL(y, 10u);
+}
+
+BOOST_AUTO_TEST_CASE(RectanglesNeverOverlap) {
+    const unsigned int size = 128;
+    OBJSkylinePacker packer(size, size);
+    vector<bool> used(size * size, false);
+    unsigned int seed = 3, area = 0;
+    for (unsigned int i = 0; i < 200; ++i) {
+        seed = seed * 1103515245u + 12345u;
+        const unsigned int w = 1 + (seed >> 16) % 24, h = 1 + (seed >> 24) % 24;
+        unsigned int x, y;
+        if (!packer.Insert(w, h, x, y)) continue;
+        BOOST_REQUIRE_LE(x + w, size);
+        BOOST_REQUIRE_LE(y + h, size);
+        for (unsigned int v = y; v < y + h; ++v)
+            for (unsigned int u = x; u < x + w; ++u) {
+                BOOST_REQUIRE(!used[v * size + u]);
+                used[v * size + u] = true;
+            }
+        area += w * h;
+    }
+    // the skyline wastes little of a random mix
+    BOOST_CHECK_GT(area, size * size / 2);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
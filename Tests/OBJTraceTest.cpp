@@ -0,0 +1,83 @@
+// OBJ trace tests.
+// -------------------------------------------------------------------
+// Copyright (C) 2007 OpenEngine.dk (See AUTHORS)
+//
+// This program is free software; It is covered by the GNU General
+// Public License version 2 or any later version.
+// See the GNU General Public License for more details (see LICENSE).
+//--------------------------------------------------------------------
+
+#include "OBJTestFile.h"
+#include <Resources/OBJResource.h>
+#include <Resources/OBJTrace.h>
+
+#include <boost/foreach.hpp>
+#include <boost/property_tree/ptree.hpp>
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/test/unit_test.hpp>
+#include <map>
+
+using namespace OpenEngine::Resources;
+using boost::property_tree::ptree;
+
+BOOST_AUTO_TEST_SUITE(OBJTraceTest)
+
+// the trace must parse as JSON, and the spans of each thread must
+// nest with their ends in reverse order of their beginnings
+BOOST_AUTO_TEST_CASE(SpansAreBalancedJson) {
+    WriteTestFile("trace.mtl", "newmtl red\nKd 1 0 0\n");
+    const string file = WriteTestFile("trace.obj",
+        "mtllib trace.mtl\nv 0 0 0\nv 1 0 0\nv 0 1 0\nusemtl red\nf 1 2 3\nl 1 2\n");
+    OBJLoadOptions options;
+    options.removeDegenerate = true;
+    OBJTrace::Start("trace.json");
+    BOOST_CHECK(OBJTrace::IsEnabled());
+    for (unsigned int i = 0; i < 2; ++i) {
+        OBJResource resource(file, options);
+        resource.Load();
+        delete resource.GetSceneNode();
+    }
+    BOOST_REQUIRE(OBJTrace::Stop());
+    BOOST_CHECK(!OBJTrace::IsEnabled());
+
+    ptree trace;
+    BOOST_REQUIRE_NO_THROW(boost::property_tree::read_json("trace.json", trace));
+    map<string, vector<string> > open;
+    map<string, unsigned int> loads;
+    map<string, boost::uint64_t> last;
+    unsigned int events = 0;
+    BOOST_FOREACH(const ptree::value_type& e, trace.get_child("traceEvents")) {
+        const string name = e.second.get<string>("name");
+        const string phase = e.second.get<string>("ph");
+        const string thread = e.second.get<string>("tid");
+        const boost::uint64_t time = e.second.get<boost::uint64_t>("ts");
+        vector<string>& stack = open[thread];
+        // time runs forward on each thread
+        BOOST_CHECK_GE(time, last[thread]);
+        last[thread] = time;
+        if (phase == "B") {
+            stack.push_back(name);
+            if (name == "Load") loads[thread]++;
+        } else {
+            BOOST_REQUIRE_EQUAL(phase, "E");
+            BOOST_REQUIRE(!stack.empty());
+            BOOST_CHECK_EQUAL(stack.back(), name);
+            stack.pop_back();
+        }
+        events++;
+    }
+    BOOST_CHECK_GT(events, 0u);
+    unsigned int total = 0;
+    for (map<string, vector<string> >::iterator i = open.begin(); i != open.end(); ++i)
+        BOOST_CHECK(i->second.empty());
+    for (map<string, unsigned int>::iterator i = loads.begin(); i != loads.end(); ++i)
+        total += i->second;
+    BOOST_CHECK_EQUAL(total, 2u);
+}
+
+BOOST_AUTO_TEST_CASE(NothingIsRecordedWhenStopped) {
+    BOOST_CHECK(!OBJTrace::IsEnabled());
+    BOOST_CHECK(!OBJTrace::Stop());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
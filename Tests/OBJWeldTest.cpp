@@ -0,0 +1,68 @@
+// OBJ vertex welding tests.
+// -------------------------------------------------------------------
+// Copyright (C) 2007 OpenEngine.dk (See AUTHORS)
+//
+// This program is free software; It is covered by the GNU General
+// Public License version 2 or any later version.
+// See the GNU General Public License for more details (see LICENSE).
+//--------------------------------------------------------------------
+
+#include <Resources/OBJWeld.h>
+#include <Resources/OBJMeshData.h>
+
+#include <boost/test/unit_test.hpp>
+#include <algorithm>
+
+using namespace OpenEngine::Resources;
+
+/**
+ * Fill mesh data with one triangle per three vertices, all with
+ * zero normals and texture coordinates.
+ */
+static void Fill(OBJMeshData& data, const float* positions) {
+    std::copy(positions, positions + data.vertexCount*3, data.vertices);
+    std::fill(data.normals, data.normals + data.vertexCount*3, 0.0f);
+    std::fill(data.texcoords, data.texcoords + data.vertexCount*2, 0.0f);
+    for (unsigned int i = 0; i < data.triangleCount*3; ++i)
+        data.indices[i] = i;
+}
+
+BOOST_AUTO_TEST_SUITE(OBJWeldTest)
+
+BOOST_AUTO_TEST_CASE(WeldsDuplicatesAndRemapsIndices) {
+    const float positions[] = { 0,0,0, 1,0,0, 0,1,0,  1,0,0, 0,1,0, 1,1,0 };
+    OBJMeshData data(6, 2);
+    Fill(data, positions);
+    BOOST_CHECK_EQUAL(OBJWeld::Weld(data, 0.0f, 0.0f, 0.0f), 2u);
+    BOOST_CHECK_EQUAL(data.vertexCount, 4u);
+    const unsigned int expected[] = { 0, 1, 2, 1, 2, 3 };
+    BOOST_CHECK_EQUAL_COLLECTIONS(data.indices, data.indices + 6, expected, expected + 6);
+}
+
+// a tolerance far below the model extent must not overflow the cell
+// coordinates
+BOOST_AUTO_TEST_CASE(SmallToleranceOnLargeExtent) {
+    const float positions[] = { 0,0,0, 1e9f,0,0, 1e9f,0,0 };
+    OBJMeshData data(3, 1);
+    Fill(data, positions);
+    BOOST_CHECK_EQUAL(OBJWeld::Weld(data, 1e-6f, 0.0f, 0.0f), 1u);
+    BOOST_CHECK_EQUAL(data.indices[1], data.indices[2]);
+}
+
+BOOST_AUTO_TEST_CASE(AttributesHaveTheirOwnTolerances) {
+    const float positions[] = { 0,0,0, 0,0,0, 1,0,0 };
+    OBJMeshData data(3, 1);
+    Fill(data, positions);
+    data.normals[2] = 1.0f;
+    data.normals[5] = 0.99f;
+    BOOST_CHECK_EQUAL(OBJWeld::Weld(data, 0.5f, 0.001f, 0.0f), 0u);
+    BOOST_CHECK_EQUAL(OBJWeld::Weld(data, 0.5f, 0.1f, 0.0f), 1u);
+
+    OBJMeshData uv(3, 1);
+    Fill(uv, positions);
+    uv.texcoords[2] = 0.25f;
+    BOOST_CHECK_EQUAL(OBJWeld::Weld(uv, 0.5f, 0.0f, 0.1f), 0u);
+    BOOST_CHECK_EQUAL(OBJWeld::Weld(uv, 0.5f, 0.0f, 0.5f), 1u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()